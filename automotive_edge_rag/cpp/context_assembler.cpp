@@ -0,0 +1,179 @@
+#include "context_assembler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+
+#include "Utf8Segmenter.h"
+
+namespace edge_llm_rag {
+
+namespace {
+
+// 解码为码点序列, 只保留字母、数字和汉字, 用于相关度和去重比较
+std::vector<uint32_t> content_code_points(const std::string &text) {
+    std::vector<uint32_t> cps;
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        size_t len      = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+        if (i + len > text.size()) break;
+
+        uint32_t cp = len == 1 ? c : c & (0x7F >> len);
+        for (size_t j = 1; j < len; ++j) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i + j]) & 0x3F);
+        }
+        i += len;
+
+        bool ascii_word = (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') ||
+                          (cp >= 'A' && cp <= 'Z');
+        bool cjk = cp >= 0x4E00 && cp <= 0x9FFF;
+        if (ascii_word || cjk) {
+            cps.push_back((cp >= 'A' && cp <= 'Z') ? cp + 32 : cp);
+        }
+    }
+    return cps;
+}
+
+// 相邻字符二元组, 中文没有空格分词, 用二元组衡量文本重合度
+std::set<uint64_t> bigrams(const std::vector<uint32_t> &cps) {
+    std::set<uint64_t> result;
+    for (size_t i = 0; i + 1 < cps.size(); ++i) {
+        result.insert((static_cast<uint64_t>(cps[i]) << 32) | cps[i + 1]);
+    }
+    if (cps.size() == 1) result.insert(cps[0]);
+    return result;
+}
+
+size_t intersection_size(const std::set<uint64_t> &a, const std::set<uint64_t> &b) {
+    size_t n = 0;
+    for (uint64_t x : a) n += b.count(x);
+    return n;
+}
+
+struct Candidate {
+    size_t chunk_index;
+    size_t sentence_index;
+    std::string text;
+    std::set<uint64_t> grams;
+    size_t tokens;
+    double score;
+};
+
+}  // namespace
+
+ContextAssembler::ContextAssembler(size_t token_budget, TokenCounter counter)
+    : token_budget_(token_budget), counter_(counter ? counter : estimate_tokens) {}
+
+size_t ContextAssembler::estimate_tokens(const std::string &text) {
+    size_t tokens   = 0;
+    size_t word_len = 0;
+    auto flush_word = [&]() {
+        tokens += (word_len + 3) / 4;
+        word_len = 0;
+    };
+
+    for (unsigned char c : text) {
+        if (c >= 0x80) {
+            flush_word();
+            if ((c & 0xC0) != 0x80) ++tokens;  // 每个多字节字符计 1 个
+        } else if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            ++word_len;
+        } else {
+            flush_word();
+            if (c != ' ') ++tokens;  // 标点、换行
+        }
+    }
+    flush_word();
+    return tokens;
+}
+
+AssembledContext ContextAssembler::assemble(const std::string &query,
+                                            const std::vector<ContextChunk> &chunks) const {
+    AssembledContext result{"", "", 0, 0, 0, 0};
+
+    text_segmenter::SegmenterConfig config;
+    config.delimiters = "。！？；\n!?;";
+    config.min_chars  = 4;
+
+    std::set<uint64_t> query_grams = bigrams(content_code_points(query));
+
+    // 步骤1: 切句并打分. 分数 = 与问题的二元组重合度为主, 片段检索相似度为辅
+    std::vector<Candidate> candidates;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        auto sentences = text_segmenter::Utf8Segmenter::split(chunks[c].text, config);
+        for (size_t s = 0; s < sentences.size(); ++s) {
+            Candidate cand;
+            cand.chunk_index    = c;
+            cand.sentence_index = s;
+            cand.text           = sentences[s];
+            cand.grams          = bigrams(content_code_points(cand.text));
+            cand.tokens         = counter_(cand.text);
+
+            double overlap = query_grams.empty() ? 0.0
+                                                 : static_cast<double>(intersection_size(
+                                                       query_grams, cand.grams)) /
+                                                       query_grams.size();
+            // 同一片段内靠前的句子通常是概述, 给一点位置加分
+            cand.score = 0.6 * overlap + 0.4 * chunks[c].similarity + 0.05 / (1.0 + s);
+            candidates.push_back(std::move(cand));
+        }
+    }
+
+    std::vector<size_t> order(candidates.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&candidates](size_t a, size_t b) {
+        return candidates[a].score > candidates[b].score;
+    });
+
+    // 步骤2: 按分数贪心选取, 跳过与已选句子高度重合的句子和放不下的句子
+    std::vector<size_t> selected;
+    for (size_t idx : order) {
+        const Candidate &cand = candidates[idx];
+
+        bool duplicate = false;
+        for (size_t sel : selected) {
+            const Candidate &other = candidates[sel];
+            size_t common          = intersection_size(cand.grams, other.grams);
+            size_t smaller         = std::min(cand.grams.size(), other.grams.size());
+            if (smaller > 0 && common >= 0.8 * smaller) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate || cand.grams.empty()) {
+            ++result.duplicates;
+            continue;
+        }
+        if (result.tokens + cand.tokens > token_budget_) {
+            ++result.over_budget;
+            continue;
+        }
+
+        selected.push_back(idx);
+        result.tokens += cand.tokens;
+    }
+
+    // 步骤3: 恢复原文顺序, 读起来连贯
+    std::sort(selected.begin(), selected.end(), [&candidates](size_t a, size_t b) {
+        if (candidates[a].chunk_index != candidates[b].chunk_index)
+            return candidates[a].chunk_index < candidates[b].chunk_index;
+        return candidates[a].sentence_index < candidates[b].sentence_index;
+    });
+
+    size_t last_chunk = chunks.size();
+    for (size_t idx : selected) {
+        const Candidate &cand = candidates[idx];
+        result.text += cand.text;
+        if (cand.chunk_index != last_chunk) {
+            if (!result.chunk_ids.empty()) result.chunk_ids += "+";
+            result.chunk_ids += chunks[cand.chunk_index].id;
+            last_chunk = cand.chunk_index;
+        }
+    }
+    result.sentences = selected.size();
+
+    return result;
+}
+
+}  // namespace edge_llm_rag
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace edge_llm_rag
+{
+
+    // 向量库检索到的一个片段
+    struct ContextChunk
+    {
+        std::string id;
+        std::string text;
+        double similarity;
+    };
+
+    // 组装结果: 选中的句子按原文顺序拼接
+    struct AssembledContext
+    {
+        std::string text;
+        std::string chunk_ids;   // 实际用到的片段ID, 以 '+' 连接
+        size_t tokens;           // text 占用的 token 数
+        size_t sentences;        // 选中的句子数
+        size_t duplicates;       // 因重复被丢弃的句子数
+        size_t over_budget;      // 因超出预算被丢弃的句子数
+    };
+
+    // RAG 上下文组装: 把 top-k 片段切成句子, 按与问题的相关度挑选, 去重后
+    // 在固定 token 预算内拼接. 无论手册片段多长, LLM 的 prefill 长度都有上限
+    class ContextAssembler
+    {
+    public:
+        using TokenCounter = std::function<size_t(const std::string &)>;
+
+        // counter 为空时使用 estimate_tokens
+        explicit ContextAssembler(size_t token_budget, TokenCounter counter = TokenCounter());
+
+        AssembledContext assemble(const std::string &query,
+                                  const std::vector<ContextChunk> &chunks) const;
+
+        size_t token_budget() const { return token_budget_; }
+
+        // 没有 LLM 分词器时的保守估计: 每个非 ASCII 字符 1 个 token, ASCII 单词每 4 个字符 1 个 token
+        static size_t estimate_tokens(const std::string &text);
+
+    private:
+        size_t token_budget_;
+        TokenCounter counter_;
+    };
+
+} // namespace edge_llm_rag
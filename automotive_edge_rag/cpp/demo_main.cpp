@@ -21,6 +21,9 @@ using namespace edge_llm_rag;
 // 全局ZMQ服务器对象,用于接收语音识别(ASR)发送的文本
 zmq_component::ZmqServer server;
 
+// 单麦克风只有驾驶位一个会话, 多音区时由 ASR 带上座位 ID
+static const char* kDriverSeatId = "driver";
+
 // 处理单个查询的函数
 void process_query(EdgeLLMRAGSystem &system, const std::string &query) {
     std::cout << "\n 处理查询: " << query << std::endl;
@@ -29,7 +32,7 @@ void process_query(EdgeLLMRAGSystem &system, const std::string &query) {
     auto start_time = std::chrono::high_resolution_clock::now();
 
     // 调用RAG系统处理查询
-    std::string response = system.process_query(query);
+    std::string response = system.process_query(query, kDriverSeatId);
 
     // 记录结束时间
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -1,16 +1,18 @@
 #pragma once
 #include "edge_llm_rag_system.h"
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
-#include <codecvt>
+#include <cstdio>
 #include <cstdlib>
-#include <cwchar>
 #include <iomanip>
 #include <iostream>
 #include <random>
-#include <regex>
 #include <thread>
 
+#include "Utf8Segmenter.h"
+#include "context_assembler.h"
 #include "query_classifier.h"
 
 namespace edge_llm_rag {
@@ -42,6 +44,24 @@ EdgeLLMRAGSystem::EdgeLLMRAGSystem() : is_initialized_(false) {
     py::object stats = searcher.attr("get_statistics")();
     std::cout << "Stats: total_documents=" << stats["total_documents"].cast<int>()
               << ", embedding_dimension=" << stats["embedding_dimension"].cast<int>() << std::endl;
+
+    // 步骤5: 上下文组装用的分词器. 设置 RAG_LLM_TOKENIZER 为 LLM 的 tokenizer 目录时用它精确计数,
+    // 否则按字符保守估计
+    ContextAssembler::TokenCounter counter;
+    if (const char *tokenizer_path = std::getenv("RAG_LLM_TOKENIZER")) {
+        try {
+            py::module_ transformers = py::module_::import("transformers");
+            llm_tokenizer_ =
+                transformers.attr("AutoTokenizer").attr("from_pretrained")(tokenizer_path);
+            counter = [this](const std::string &text) {
+                return static_cast<size_t>(py::len(llm_tokenizer_.attr("tokenize")(text)));
+            };
+            std::cout << "LLM tokenizer loaded: " << tokenizer_path << std::endl;
+        } catch (const std::exception &e) {
+            std::cerr << "LLM tokenizer load failed, using estimate: " << e.what() << std::endl;
+        }
+    }
+    context_assembler_ = std::make_unique<ContextAssembler>(kContextTokenBudget, counter);
 }
 
 EdgeLLMRAGSystem::~EdgeLLMRAGSystem() {}
@@ -72,10 +92,13 @@ std::string EdgeLLMRAGSystem::process_query(const std::string &query, const std:
         return "系统未初始化";
     }
 
-    // 步骤1: 先查缓存,如果之前问过相同问题直接返回
-    std::string cached_response = get_from_cache(query);
-    if (!cached_response.empty()) {
-        return cached_response;  // 缓存命中,直接返回
+    // 步骤1: 先查缓存,如果之前问过相同问题直接返回.
+    // 带 user_id 的多轮对话里同一句追问 ("那要多久?") 含义取决于上下文, 不走缓存
+    if (user_id.empty()) {
+        std::string cached_response = get_from_cache(query);
+        if (!cached_response.empty()) {
+            return cached_response;  // 缓存命中,直接返回
+        }
     }
 
     // 步骤2: 对问题进行分类(紧急、事实、创意、复杂、未知)
@@ -101,23 +124,28 @@ std::string EdgeLLMRAGSystem::process_query(const std::string &query, const std:
             std::cout << "复杂查询 detected, using hybrid response." << std::endl;
             std::cout << "===============================" << std::endl;
 
-            response = hybrid_response(query);  // 混合模式:RAG+LLM综合回答
+            // 混合模式:RAG+LLM综合回答
+            response = hybrid_response(query, classification.query_type, user_id);
             break;
         case QueryClassification::CREATIVE_QUERY:  // 创意问题(如"推荐旅游路线")
             std::cout << "===============================" << std::endl;
             std::cout << "创意查询 detected, using LLM only response." << std::endl;
             std::cout << "===============================" << std::endl;
-            response = llm_only_response(query);  // 只用LLM,生成创意内容
+            // 只用LLM,生成创意内容
+            response = llm_only_response(query, classification.query_type, user_id);
             break;
         default:  // 未知类型
             std::cout << "===============================" << std::endl;
             std::cout << "未知查询类型, using adaptive response." << std::endl;
             std::cout << "===============================" << std::endl;
-            response = hybrid_response(query);  // 默认用混合模式
+            // 默认用混合模式
+            response = hybrid_response(query, classification.query_type, user_id);
     }
 
     // 步骤4: 将问题和答案加入缓存
-    add_to_cache(query, response);
+    if (user_id.empty()) {
+        add_to_cache(query, response);
+    }
 
     return response;
 }
@@ -131,68 +159,76 @@ QueryClassification EdgeLLMRAGSystem::classify_query(const std::string &query) {
     return query_classifier_->classify_query(query);
 }
 
-// 将RAG答案按句子分割后发送给TTS(文字转语音)
-void EdgeLLMRAGSystem::rag_message_worker(const std::string &rag_text) {
-    // 定义句子分隔符:句号、问号、感叹号等
-    static const std::wregex wide_delimiter(L"([。！？；：\n]|\\?\\s|\\!\\s|\\；|\\，|\\、|\\|)");
-    const std::wstring END_MARKER = L"END";
-
-    // UTF-8转宽字符(处理中文)
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-
-    std::wstring wide_text = converter.from_bytes(rag_text) + END_MARKER;
-
-    // 找到所有句子分隔符的位置
-    std::wsregex_iterator it(wide_text.begin(), wide_text.end(), wide_delimiter);
-    std::wsregex_iterator end;
-
-    // 跳过前两个分隔符(避免开头的短句)
-    int skip_counter = 0;
-    size_t last_pos  = 0;
-    while (it != end && skip_counter < 2) {
-        last_pos = it->position() + it->length();
-        ++it;
-        ++skip_counter;
+// 把合并后的一批短句作为一条多帧消息发送给TTS
+void EdgeLLMRAGSystem::send_to_tts(const std::vector<std::string> &batch) {
+    auto response = tts_client_.request(batch);
+    std::cout << "[tts -> RAG] received: " << response << std::endl;
+}
+
+// 手册片段播报正文 (manual_speech_text) 的 FNV-1a 哈希, 与 tts_server 的 AudioPack::text_hash 一致.
+// 手册重建索引而音频包未重建时哈希对不上, TTS 按未命中处理
+static uint32_t manual_text_hash(const std::string &text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 片段已在建索引时离线合成 (tts_server/tools/tts_pack), 只发 "<play chunk=ID hash=H>",
+// TTS 从音频包取音频直接播放, 首包延迟只剩设备延迟
+bool EdgeLLMRAGSystem::play_prerendered(const std::string &chunk_id, const std::string &text) {
+    auto is_digit = [](unsigned char c) { return std::isdigit(c) != 0; };
+    if (chunk_id.empty() || !std::all_of(chunk_id.begin(), chunk_id.end(), is_digit)) {
+        return false;
     }
 
-    // 逐句提取并发送给TTS
-    while (it != end) {
-        size_t seg_start = last_pos;
-        size_t seg_end   = it->position();
-        last_pos         = seg_end + it->length();
+    char hash[16];
+    std::snprintf(hash, sizeof(hash), "%08x", manual_text_hash(text));
+    std::string command = "<play chunk=" + chunk_id + " hash=" + hash + ">";
+    auto response       = tts_client_.request(std::vector<std::string>{command});
+    std::cout << "[tts -> RAG] received: " << response << std::endl;
+    return response == "play chunk ok";
+}
 
-        // 提取一个句子
-        std::wstring wide_segment = wide_text.substr(seg_start, seg_end - seg_start);
+// 将RAG答案按句子分割后发送给TTS(文字转语音)
+void EdgeLLMRAGSystem::rag_message_worker(const std::string &rag_text,
+                                          const std::string &chunk_id) {
+    // 片段开头的章节/子章节元数据不播报. 音频包按同样的正文合成并计算哈希
+    const std::string speech = text_segmenter::manual_speech_text(rag_text);
+    if (play_prerendered(chunk_id, speech)) {
+        return;
+    }
 
-        // 去除前后空白字符
-        wide_segment.erase(0, wide_segment.find_first_not_of(L" \t\n\r"));
-        wide_segment.erase(wide_segment.find_last_not_of(L" \t\n\r") + 1);
+    // 句子分隔符:句号、问号、感叹号等, 分隔符本身不发送.
+    // 开头过短的句子与后文合并, 避免首包只有几个字. 与 TTS 离线预合成的分句一致
+    static const text_segmenter::SegmenterConfig config = text_segmenter::manual_speech_config();
 
-        if (!wide_segment.empty()) {
-            // 转换回UTF-8并发送给TTS服务进行语音合成
-            auto response1 = tts_client_.request(converter.to_bytes(wide_segment));
-            std::cout << "[tts -> RAG] received: " << response1 << std::endl;
-        }
-        ++it;
+    std::vector<std::string> segments = text_segmenter::Utf8Segmenter::split(speech, config);
+
+    // 最后一句带上结束标记, 通知TTS本轮回答结束
+    if (segments.empty()) {
+        segments.push_back("END");
+    } else {
+        segments.back() += "END";
     }
 
-    // 处理最后剩余的内容
-    if (last_pos < wide_text.length()) {
-        std::wstring last_segment = wide_text.substr(last_pos);
-        if (!last_segment.empty()) {
-            auto response1 = tts_client_.request(converter.to_bytes(last_segment));
-            std::cout << "[tts -> RAG] received: " << response1 << std::endl;
-        }
+    tts_coalescer_.reset();
+    for (const auto &segment : segments) {
+        // 经合并后发送给TTS服务进行语音合成
+        tts_coalescer_.push(segment);
     }
+    tts_coalescer_.flush();
 }
 
-// RAG模式: 只从向量数据库检索答案,不使用LLM
-std::string EdgeLLMRAGSystem::rag_only_response(const std::string &query, bool preload) {
+// 检索: 返回相似度超过阈值的前 top_k 个片段, 按相似度从高到低排列
+std::vector<ContextChunk> EdgeLLMRAGSystem::retrieve(const std::string &query, int top_k) {
     // 计时开始
     auto t0 = std::chrono::high_resolution_clock::now();
 
-    // 调用Python搜索器: top_k=1(返回1个结果), threshold=0.5(相似度阈值)
-    py::object results = searcher.attr("search")(query, 1, 0.5);
+    // 调用Python搜索器: threshold=0.5(相似度阈值)
+    py::object results = searcher.attr("search")(query, top_k, 0.5);
 
     auto t1   = std::chrono::high_resolution_clock::now();
     double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
@@ -200,57 +236,116 @@ std::string EdgeLLMRAGSystem::rag_only_response(const std::string &query, bool p
     std::cout << "\nQuery: '" << query << "'\n";
     std::cout << "elapsed: " << std::fixed << std::setprecision(2) << ms << " ms\n";
 
-    // 检查是否找到结果
-    if (py::len(results) == 0) {
-        std::cout << "  No results" << std::endl;
-        return "No results !!!";
-    }
-
     // 提取搜索结果
-    std::string answer;
+    std::vector<ContextChunk> chunks;
     for (const auto &item : results) {
-        double sim             = item["similarity"].cast<double>();  // 相似度分数
-        std::string text       = item["text"].cast<std::string>();   // 文本内容
-        answer                 = item["text"].cast<std::string>();
+        ContextChunk chunk;
+        chunk.similarity       = item["similarity"].cast<double>();       // 相似度分数
+        chunk.text             = item["text"].cast<std::string>();        // 文本内容
+        chunk.id               = py::str(item["id"]).cast<std::string>();  // 片段ID
         std::string section    = item["section"].cast<std::string>();     // 章节名
         std::string subsection = item["subsection"].cast<std::string>();  // 子章节名
 
         // 打印搜索结果摘要
-        std::cout << "  sim=" << std::fixed << std::setprecision(4) << sim
+        std::cout << "  sim=" << std::fixed << std::setprecision(4) << chunk.similarity
                   << ", section=" << section << (subsection.empty() ? "" : ("/" + subsection))
-                  << ", text=" << text.substr(0, 100) << "...\n";
+                  << ", text=" << chunk.text.substr(0, 100) << "...\n";
+        chunks.push_back(std::move(chunk));
+    }
+
+    if (chunks.empty()) {
+        std::cout << "  No results" << std::endl;
+    }
+    return chunks;
+}
+
+// RAG模式: 只从向量数据库检索答案,不使用LLM
+std::string EdgeLLMRAGSystem::rag_only_response(const std::string &query, bool preload) {
+    // top_k=1: 直接播报最相关的片段
+    std::vector<ContextChunk> chunks = retrieve(query, 1);
+    if (chunks.empty()) {
+        return "No results !!!";
     }
+    std::string answer = chunks.front().text;
 
     // 如果不是预加载模式,将答案发送给TTS进行语音播报
     if (!preload) {
-        rag_message_worker(answer);
+        rag_message_worker(answer, chunks.front().id);
     }
 
     return answer;
 }
 
+// 按问题类型限定生成长度: 语音回答超过两三句基本没人听完, 提前结束能尽快释放NPU.
+// 格式: "<gen max_new_tokens=N max_sentences=M priority=P[ cache=0][ session=ID]>", 由LLM服务解析
+std::string EdgeLLMRAGSystem::generation_tag(QueryClassification::QueryType query_type,
+                                             const std::string &user_id) {
+    int max_new_tokens = 100;
+    int max_sentences  = 3;
+    int priority       = 1;  // 0 为紧急, LLM 服务优先处理并打断正在进行的回答
+    bool cacheable     = true;  // 创意类回答希望每次不同, 不走 LLM 回答缓存
+    switch (query_type) {
+        case QueryClassification::EMERGENCY_QUERY:  // 紧急: 一句话说清楚怎么做
+            max_new_tokens = 40;
+            max_sentences  = 1;
+            priority       = 0;
+            break;
+        case QueryClassification::FACTUAL_QUERY:  // 事实: 给出要点即可
+            max_new_tokens = 60;
+            max_sentences  = 2;
+            break;
+        case QueryClassification::COMPLEX_QUERY:  // 复杂: 需要稍作解释
+            max_new_tokens = 80;
+            max_sentences  = 3;
+            break;
+        case QueryClassification::CREATIVE_QUERY:  // 创意: 允许多说一点
+            max_new_tokens = 100;
+            max_sentences  = 4;
+            cacheable      = false;
+            break;
+        default:
+            max_new_tokens = 60;
+            max_sentences  = 2;
+    }
+    return "<gen max_new_tokens=" + std::to_string(max_new_tokens) +
+           " max_sentences=" + std::to_string(max_sentences) +
+           " priority=" + std::to_string(priority) + (cacheable ? "" : " cache=0") +
+           (user_id.empty() ? "" : " session=" + user_id) + ">";
+}
+
 // LLM模式: 只使用大语言模型生成答案,不查询向量库
-std::string EdgeLLMRAGSystem::llm_only_response(const std::string &query) {
-    // 直接将问题发送给LLM服务(通过ZMQ通信)
-    auto response = llm_client_.request(query);
+std::string EdgeLLMRAGSystem::llm_only_response(const std::string &query,
+                                                QueryClassification::QueryType query_type,
+                                                const std::string &user_id) {
+    // 直接将问题发送给LLM服务(通过ZMQ通信), 带上本次的生成预算和会话
+    auto response = llm_client_.request(generation_tag(query_type, user_id) + query);
     std::cout << "[tts -> RAG] received: " << response << std::endl;
     return response;
 }
 
 // 混合模式: 先用RAG检索相关信息,再让LLM基于这些信息生成答案
-std::string EdgeLLMRAGSystem::hybrid_response(const std::string &query) {
-    // 步骤1: 先从向量库检索相关信息(preload=true表示不播报)
-    std::string rag_part = rag_only_response(query, true);
+std::string EdgeLLMRAGSystem::hybrid_response(const std::string &query,
+                                              QueryClassification::QueryType query_type,
+                                              const std::string &user_id) {
+    // 步骤1: 从向量库检索前几个相关片段
+    std::vector<ContextChunk> chunks = retrieve(query, kHybridTopK);
 
     // 步骤2: 如果RAG没找到相关内容,直接用LLM回答
-    if (rag_part.find("No results") != std::string::npos) {
-        return llm_only_response(query);
+    if (chunks.empty()) {
+        return llm_only_response(query, query_type, user_id);
     }
 
-    // 步骤3: 将问题和RAG检索的内容一起发给LLM
-    // 格式: "用户问题<rag>手册相关内容"
-    std::string llm_query = query + "<rag>" + rag_part;
-    std::string llm_part  = llm_only_response(llm_query);
+    // 步骤3: 在 token 预算内挑选与问题最相关的句子
+    AssembledContext context = context_assembler_->assemble(query, chunks);
+    std::cout << "[context] tokens=" << context.tokens << "/" << context_assembler_->token_budget()
+              << ", sentences=" << context.sentences << ", duplicates=" << context.duplicates
+              << ", over_budget=" << context.over_budget << ", chunks=" << context.chunk_ids
+              << std::endl;
+
+    // 步骤4: 将问题和组装后的内容一起发给LLM
+    // 格式: "用户问题<rag id=片段ID>手册相关内容"
+    std::string llm_query = query + "<rag id=" + context.chunk_ids + ">" + context.text;
+    std::string llm_part  = llm_only_response(llm_query, query_type, user_id);
 
     return llm_part;  // 返回LLM综合生成的答案
 }
@@ -11,9 +11,11 @@
 
 #include <unordered_map>
 #include <atomic>
+#include "context_assembler.h"
 #include "query_classifier.h"
 #include "ZmqServer.h"
 #include "ZmqClient.h"
+#include "MessageCoalescer.h"
 
 namespace fs = std::filesystem;
 
@@ -38,9 +40,17 @@ namespace edge_llm_rag
 
         std::string rag_only_response(const std::string &query, bool preload = false);
 
-        std::string llm_only_response(const std::string &query);
+        // query_type 决定本次生成的 token 上限和句数上限, 见 generation_tag().
+        // user_id 非空时 LLM 服务按该 ID 保存多轮历史, 追问不必重复上下文
+        std::string llm_only_response(const std::string &query,
+                                      QueryClassification::QueryType query_type =
+                                          QueryClassification::CREATIVE_QUERY,
+                                      const std::string &user_id = "");
 
-        std::string hybrid_response(const std::string &query);
+        std::string hybrid_response(const std::string &query,
+                                    QueryClassification::QueryType query_type =
+                                        QueryClassification::COMPLEX_QUERY,
+                                    const std::string &user_id = "");
 
         bool cleanup_cache();
 
@@ -53,16 +63,35 @@ namespace edge_llm_rag
         zmq_component::ZmqClient tts_client_{"tcp://localhost:7777"};
         zmq_component::ZmqClient llm_client_{"tcp://localhost:8899"};
 
+        // 合并相邻短句后再发给TTS, 首句立即发送
+        zmq_component::MessageCoalescer tts_coalescer_{
+            [this](const std::vector<std::string> &batch)
+            { send_to_tts(batch); }};
+
         std::unique_ptr<QueryClassifier>
             query_classifier_;
 
         std::unordered_map<std::string, std::string> query_cache_;
 
+        // LLM 上下文 256 token, 其中 100 留给生成, 再扣除提示词前导、问题和模板
+        static constexpr size_t kContextTokenBudget = 96;
+        static constexpr int kHybridTopK            = 3;
+
+        py::object llm_tokenizer_;
+        std::unique_ptr<ContextAssembler> context_assembler_;
+
+        std::vector<ContextChunk> retrieve(const std::string &query, int top_k);
+        static std::string generation_tag(QueryClassification::QueryType query_type,
+                                          const std::string &user_id);
+
         bool add_to_cache(const std::string &query, const std::string &response);
         std::string get_from_cache(const std::string &query);
         bool is_cache_valid(const std::string &query);
 
-        void rag_message_worker(const std::string &rag_text);
+        // chunk_id 非空时先请 TTS 直接播放离线预合成的音频包, 没有再发原文
+        void rag_message_worker(const std::string &rag_text, const std::string &chunk_id = "");
+        bool play_prerendered(const std::string &chunk_id, const std::string &text);
+        void send_to_tts(const std::vector<std::string> &batch);
         bool preload_common_queries();
     };
 
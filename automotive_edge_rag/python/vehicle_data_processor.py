@@ -261,6 +261,26 @@ class VehicleDataProcessor:
             json.dump(json_data, f, ensure_ascii=False, indent=2)
         logger.info(f"JSON格式数据已保存到: {json_file}")
 
+    @staticmethod
+    def save_tts_chunks(texts: List[str], metadata: List[Dict[str, Any]],
+                        tts_file: str = "vector_db/tts_chunks.tsv"):
+        """
+        导出供 TTS 离线预合成的片段原文
+
+        RAG 直接播报时朗读的就是检索到的片段原文, 内容完全可预知.
+        tts_server 的 tts_pack 工具读取该文件, 按与 RAG 播报相同的分句逐句合成, 生成音频包.
+        每行 "片段ID<TAB>原文", 原文中的反斜杠、换行和制表符按 C 风格转义
+
+        Args:
+            texts: 文本列表
+            metadata: 元数据列表(提供片段ID)
+        """
+        with open(tts_file, 'w', encoding='utf-8') as f:
+            for text, meta in zip(texts, metadata):
+                escaped = text.replace('\\', '\\\\').replace('\n', '\\n').replace('\t', '\\t')
+                f.write(f"{meta['id']}\t{escaped}\n")
+        logger.info(f"TTS 片段原文已保存到: {tts_file}")
+
     def create_search_index(self, embeddings: np.ndarray, texts: List[str], metadata: List[Dict[str, Any]]):
         """
         创建搜索索引
@@ -321,6 +341,7 @@ class VehicleDataProcessor:
 
         # 步骤4: 保存向量数据库文件
         self.save_vector_database(embeddings, texts, metadata)
+        self.save_tts_chunks(texts, metadata)
 
         # 步骤5: 创建搜索索引
         self.create_search_index(embeddings, texts, metadata)
@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "RagUtils.h"
+
+struct AnswerCacheConfig {
+    size_t capacity = 64;  // 0 表示关闭缓存
+    int ttl_seconds = 0;   // 0 表示不过期
+};
+
+// 一轮完整回答: 发送线程交给 TTS 的分句结果, tail 与 END 同帧发送
+struct CachedAnswer {
+    std::vector<std::string> segments;
+    std::string tail;
+};
+
+// 回答缓存: key 由规范化后的问题、RAG 内容哈希和生成参数组成, 按 LRU 淘汰.
+// 推理线程查询、发送线程写入, 内部加锁
+class AnswerCache {
+   public:
+    explicit AnswerCache(AnswerCacheConfig config = AnswerCacheConfig());
+
+    bool enabled() const { return config_.capacity > 0; }
+
+    // 不可缓存的请求返回空串
+    static std::string makeKey(const RagRequest& request);
+    // 去掉空白和标点并把 ASCII 转小写, "打开空调。" 与 "打开空调" 视为同一问题
+    static std::string normalizeQuery(const std::string& query);
+
+    std::shared_ptr<const CachedAnswer> lookup(const std::string& key);
+    void insert(const std::string& key, CachedAnswer answer);
+
+    size_t hits() const;
+    size_t misses() const;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CachedAnswer> answer;
+        Clock::time_point stored;
+    };
+
+    AnswerCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t hits_   = 0;
+    size_t misses_ = 0;
+};
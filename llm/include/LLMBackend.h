@@ -0,0 +1,64 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 推理回调状态, 与具体推理框架无关
+enum class LLMRunState { NORMAL, FINISH, ERROR };
+
+// 单次请求的生成参数, 由调用方按问题类型给出
+struct GenerationParams {
+    int max_new_tokens = 100;  // 不超过后端初始化时的上限
+    int max_sentences  = 0;    // 说完这么多句后停止生成, 0 表示不限制. 由 VoiceLLMService 按分句结果执行
+};
+
+// 系统提示词的一段. cache_key 非空时, 后端可以缓存 "这一段及之前所有段" 的 prefill 结果,
+// 之后前缀相同的请求直接恢复该状态, 只 prefill 变化的部分
+struct PromptPart {
+    std::string cache_key;
+    std::string text;
+};
+
+// 多轮对话中已经完成的一轮
+struct ChatTurn {
+    std::string user;
+    std::string assistant;
+};
+
+// LLM 推理后端接口: rkllm(NPU)、llama.cpp(CPU, GGUF)、mock(脚本化输出) 共用,
+// VoiceLLMService 只依赖该接口, 可在没有 NPU 的机器上构建和压测
+class LLMBackend {
+   public:
+    // 每生成一段文本回调一次 NORMAL, 结束时回调 FINISH (text 为空), 出错时回调 ERROR
+    using Callback = std::function<void(const char* text, LLMRunState state)>;
+
+    virtual ~LLMBackend() = default;
+
+    virtual bool init(const std::string& model_path) = 0;
+    virtual void setChatTemplate(const std::string& system_prompt) = 0;
+    // 分段设置系统提示词 (固定前导 + RAG 片段...). 默认拼接后交给 setChatTemplate, 不做缓存
+    virtual void setSystemPrompt(const std::vector<PromptPart>& parts);
+    // 多轮对话历史, 每轮在 setSystemPrompt() 之后、run() 之前设置, 单轮请求传空.
+    // 同一 session_id 的历史只在末尾追加或从开头裁剪, 后端可以据此复用上一轮保留的状态.
+    // 默认忽略历史
+    virtual void setHistory(const std::string& session_id, const std::vector<ChatTurn>& turns);
+    // 阻塞直到生成结束或被 cancel(), 期间在调用线程或推理线程上回调.
+    // 无论正常结束、达到 max_new_tokens 还是被取消, 都恰好回调一次 FINISH (或 ERROR)
+    virtual void run(const std::string& user_input, const GenerationParams& params,
+                     const Callback& callback) = 0;
+    // 线程安全, 中止正在进行的 run()
+    virtual void cancel() = 0;
+
+    virtual const char* name() const = 0;
+};
+
+struct LLMBackendOptions {
+    int cpu_threads               = 4;     // llama.cpp 推理线程数
+    double mock_tokens_per_second = 20.0;  // mock 后端输出速率
+};
+
+// type: "rkllm" / "llama" / "mock", 为空时选择编译进来的首选后端. 不支持的类型返回 nullptr
+std::unique_ptr<LLMBackend> createLLMBackend(const std::string& type,
+                                             const LLMBackendOptions& options = LLMBackendOptions());
+std::vector<std::string> availableLLMBackends();
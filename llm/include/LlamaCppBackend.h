@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LLMBackend.h"
+
+struct llama_model;
+struct llama_context;
+struct llama_sampler;
+
+// CPU 后端: 通过 llama.cpp 加载 GGUF 模型, 使用模型自带的对话模板.
+// 带 cache_key 的系统提示词前缀和多轮历史的每一轮 prefill 后保存序列状态, 前缀相同的请求直接恢复
+class LlamaCppBackend : public LLMBackend {
+   public:
+    explicit LlamaCppBackend(int n_threads = 4, size_t max_prefix_cache_entries = 8);
+    ~LlamaCppBackend() override;
+
+    bool init(const std::string& model_path) override;
+    void setChatTemplate(const std::string& system_prompt) override;
+    void setSystemPrompt(const std::vector<PromptPart>& parts) override;
+    void setHistory(const std::string& session_id, const std::vector<ChatTurn>& turns) override;
+    void run(const std::string& user_input, const GenerationParams& params,
+             const Callback& callback) override;
+    void cancel() override;
+
+    const char* name() const override { return "llama"; }
+
+   private:
+    struct PrefixCacheEntry {
+        std::string key;  // 各级 cache_key 的路径
+        size_t n_tokens = 0;
+        std::vector<uint8_t> state;
+        uint64_t last_used = 0;
+    };
+
+    // 渲染系统提示词 + 前 n_turns 轮历史, user_input 非空时再加本轮输入和助手开头
+    std::string renderChat(size_t n_turns, const std::string* user_input) const;
+    bool decode(std::vector<int32_t>& tokens);
+    std::vector<int32_t> tokenize(const std::string& text, bool add_special) const;
+    // tokens[from..] 还原成文本, 去掉开头不完整的 UTF-8 字符
+    std::string detokenize(const std::vector<int32_t>& tokens, size_t from) const;
+    PrefixCacheEntry* findPrefix(const std::string& key);
+    void savePrefix(const std::string& key, size_t n_tokens);
+
+    int n_threads_;
+    int max_context_len_ = 256;
+    int max_new_tokens_  = 100;
+
+    llama_model* model_     = nullptr;
+    llama_context* ctx_     = nullptr;
+    llama_sampler* sampler_ = nullptr;
+
+    std::vector<PromptPart> system_parts_;
+    std::string system_prompt_;
+    std::vector<ChatTurn> history_;
+
+    size_t max_prefix_entries_;
+    std::vector<PrefixCacheEntry> prefix_cache_;
+    uint64_t use_counter_ = 0;
+
+    std::atomic<bool> cancelled_{false};
+};
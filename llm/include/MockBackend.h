@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "LLMBackend.h"
+
+// 确定性的模拟后端: 按固定速率逐 token 输出脚本文本, 用于没有 NPU 时的功能测试和性能测量.
+// init() 的参数为脚本文件路径, 每行一条回答, 按请求顺序循环使用; 为空或 "-" 时使用内置脚本
+class MockBackend : public LLMBackend {
+   public:
+    explicit MockBackend(double tokens_per_second = 20.0, size_t chars_per_token = 2);
+
+    bool init(const std::string& model_path) override;
+    void setChatTemplate(const std::string& system_prompt) override;
+    void run(const std::string& user_input, const GenerationParams& params,
+             const Callback& callback) override;
+    void cancel() override;
+
+    const char* name() const override { return "mock"; }
+
+    void setTokensPerSecond(double tokens_per_second) { tokens_per_second_ = tokens_per_second; }
+
+   private:
+    std::vector<std::string> tokenize(const std::string& text) const;
+
+    double tokens_per_second_;
+    size_t chars_per_token_;
+    std::vector<std::string> script_;
+    size_t next_answer_ = 0;
+    std::atomic<bool> cancelled_{false};
+};
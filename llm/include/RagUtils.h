@@ -1,6 +1,31 @@
 #pragma once
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "LLMBackend.h"
+
+// 请求优先级, 数值越小越先处理
+constexpr int kPriorityEmergency = 0;
+constexpr int kPriorityNormal    = 1;
+
+struct RagRequest {
+    GenerationParams generation;
+    int priority   = kPriorityNormal;
+    bool cacheable = true;   // <gen cache=0>: 不查也不写回答缓存
+    std::string session_id;  // <gen session=ID>: 按用户/座位保存多轮历史, 为空表示单轮
+    std::string query;
+    std::string rag;       // 检索到的手册内容, 为空表示纯 LLM 问答
+    std::string chunk_id;  // 检索片段 ID, 可选
+};
+
+// 格式: "[<gen 属性...>]用户问题[<rag[ id=片段ID]>手册内容]"
+// <gen> 属性: max_new_tokens=N max_sentences=M priority=P cache=0|1 session=ID
+// <gen> 可省略, 省略的字段使用默认值
+RagRequest parseRagRequest(const std::string& input);
 std::pair<std::string, std::string> splitRagTag(const std::string& input);
+
 std::string buildRagPrompt(const std::string& rag);
+// 分段版本: 固定前导和 RAG 片段各自带缓存 key. 片段内容按问题挑选过句子,
+// 同一 chunk_id 的内容可能不同, 所以 key 总是包含内容哈希
+std::vector<PromptPart> buildRagPromptParts(const std::string& rag, const std::string& chunk_id);
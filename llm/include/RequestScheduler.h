@@ -0,0 +1,35 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+#include "RagUtils.h"
+
+struct SchedulerConfig {
+    size_t capacity = 8;
+    // 新请求取代队列中同优先级的旧请求: 驾驶员已经换了问题, 旧问题不用再回答
+    bool supersede_same_priority = true;
+};
+
+// 有界优先级请求队列, 接收线程入队、推理线程出队.
+// 优先级数值越小越先处理, 同优先级先进先出
+class RequestScheduler {
+   public:
+    explicit RequestScheduler(SchedulerConfig config = SchedulerConfig());
+
+    // 队列满时丢弃优先级最低的最旧请求; 新请求本身优先级最低时丢弃新请求.
+    // 返回被丢弃或取代的请求数
+    size_t submit(RagRequest request);
+    // 阻塞直到取到请求, stop() 后返回 false
+    bool pop(RagRequest& request);
+    void stop();
+    size_t size() const;
+
+   private:
+    SchedulerConfig config_;
+    std::deque<RagRequest> queue_;  // 按优先级排序
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stopped_ = false;
+};
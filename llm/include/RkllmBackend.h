@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "LLMBackend.h"
+#include "rkllm.h"
+
+// Rockchip NPU 后端, 封装 rkllm_init/rkllm_run
+class RkllmBackend : public LLMBackend {
+   public:
+    RkllmBackend() = default;
+    ~RkllmBackend() override;
+
+    bool init(const std::string& model_path) override;
+    void setChatTemplate(const std::string& system_prompt) override;
+    // 所有片段都带 cache_key 且与上一轮相同时保留系统提示词的 KV cache, 不重新 prefill
+    void setSystemPrompt(const std::vector<PromptPart>& parts) override;
+    // 同一会话连续两轮且系统提示词未变时保留运行时中的对话 KV (keep_history),
+    // 本轮只 prefill 新输入; 否则清空对话部分, 把历史拼在本轮输入前面
+    void setHistory(const std::string& session_id, const std::vector<ChatTurn>& turns) override;
+    void run(const std::string& user_input, const GenerationParams& params,
+             const Callback& callback) override;
+    void cancel() override;
+
+    const char* name() const override { return "rkllm"; }
+
+   private:
+    LLMHandle handle_    = nullptr;
+    int max_context_len_ = 256;
+    std::string system_prompt_;
+    std::string system_prompt_key_;  // 当前 KV cache 中系统提示词的 key, 为空表示不可复用
+    bool reuse_system_prompt_ = false;
+    bool prompt_changed_      = true;  // 上一轮 run() 之后换过系统提示词
+
+    // 本轮的会话
+    std::string session_id_;
+    std::vector<ChatTurn> history_;
+    bool resume_ = false;
+
+    // 运行时 KV 中保留的对话: 哪个会话, 当时的历史, 最后一轮的用户输入, 估计占用的 token 数
+    std::string kv_session_;
+    std::vector<ChatTurn> kv_history_;
+    std::string kv_last_user_;
+    size_t kv_tokens_ = 0;
+};
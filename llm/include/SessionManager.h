@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LLMBackend.h"
+
+struct SessionConfig {
+    size_t max_history_tokens = 96;    // 单个会话保留的历史上限, 超出时从最早的一轮开始丢弃
+    size_t max_total_tokens   = 1024;  // 所有会话历史的总上限, 超出时淘汰最久未用的会话
+    int idle_timeout_seconds  = 300;   // 超过这么久没有新问题视为换了话题, 0 表示不过期
+};
+
+// 按用户/座位 ID 保存多轮对话历史. token 数按码点估计 (中文约一字一 token), 偏保守.
+// 推理线程读取、发送线程写入, 内部加锁
+class SessionManager {
+   public:
+    explicit SessionManager(SessionConfig config = SessionConfig());
+
+    // 会话不存在或已过期时返回空
+    std::vector<ChatTurn> history(const std::string& session_id);
+    // 追加一轮并按预算裁剪
+    void append(const std::string& session_id, ChatTurn turn);
+    void erase(const std::string& session_id);
+
+    size_t sessionCount() const;
+    size_t totalTokens() const;
+
+    static size_t estimateTokens(const ChatTurn& turn);
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Session {
+        std::string id;
+        std::vector<ChatTurn> turns;
+        size_t tokens = 0;
+        Clock::time_point last_used;
+    };
+
+    bool expired(const Session& session) const;
+    void eraseLocked(std::list<Session>::iterator it);
+
+    SessionConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Session> sessions_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<Session>::iterator> index_;
+    size_t total_tokens_ = 0;
+};
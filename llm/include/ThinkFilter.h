@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// 流式过滤 <think>...</think> 推理内容: 按字节喂入, 标签可以跨 token 切开,
+// 只输出标签之外的文本. 非线程安全, 每轮回答结束后 reset()
+class ThinkFilter {
+   public:
+    // 对话模板已经在提示词中打开 <think> 时, start_inside 设为 true, 直到遇到 </think> 才开始输出
+    explicit ThinkFilter(bool start_inside = false);
+
+    // 把可见文本追加到 out
+    void feed(const char* data, size_t length, std::string& out);
+    // 回答结束: 标签外未匹配完的前缀按普通文本输出, 标签内的内容丢弃
+    void finish(std::string& out);
+    void reset();
+
+    size_t droppedBytes() const { return dropped_bytes_; }
+
+   private:
+    bool start_inside_;
+    bool inside_;
+    std::string pending_;  // 可能是标签前缀的字节
+    size_t dropped_bytes_ = 0;
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LLMBackend.h"
+
+// 推理回调线程 -> 发送线程的单生产者/单消费者无锁队列.
+// 每个槽位内联存放一段原始 UTF-8 字节, 生产者不分配内存也不加锁;
+// 只有消费者已经睡眠时才加一次锁唤醒它.
+class TokenRing {
+   public:
+    static constexpr size_t kSlotBytes = 52;
+
+    struct Slot {
+        LLMRunState state;
+        uint32_t length;
+        char data[kSlotBytes];
+    };
+
+    // capacity 向上取整为 2 的幂
+    explicit TokenRing(size_t capacity = 1024) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    TokenRing(const TokenRing&)            = delete;
+    TokenRing& operator=(const TokenRing&) = delete;
+
+    // 生产者侧. 超过一个槽位的文本拆成多个槽位, 只有最后一个携带 state.
+    // 队列满时让出 CPU 重试, 返回等待过的次数
+    size_t push(const char* text, size_t length, LLMRunState state) {
+        size_t full_waits = 0;
+        do {
+            size_t chunk = std::min(length, kSlotBytes);
+            bool last    = chunk == length;
+
+            size_t write = write_pos_.load(std::memory_order_relaxed);
+            while (write - read_pos_.load(std::memory_order_acquire) > mask_) {
+                ++full_waits;
+                std::this_thread::yield();
+            }
+
+            Slot& slot  = slots_[write & mask_];
+            slot.state  = last ? state : LLMRunState::NORMAL;
+            slot.length = static_cast<uint32_t>(chunk);
+            // FINISH 等状态帧以 (nullptr, 0) 推入, memcpy 不允许空指针
+            if (chunk) memcpy(slot.data, text, chunk);
+            write_pos_.store(write + 1, std::memory_order_release);
+
+            text += chunk;
+            length -= chunk;
+        } while (length > 0);
+
+        wakeReader();
+        return full_waits;
+    }
+
+    // 消费者侧, 无数据时返回 false
+    bool tryPop(Slot& slot) {
+        size_t read = read_pos_.load(std::memory_order_relaxed);
+        if (read == write_pos_.load(std::memory_order_acquire)) return false;
+
+        slot = slots_[read & mask_];
+        read_pos_.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者侧, 阻塞直到取到数据; stop() 后队列为空时返回 false
+    bool pop(Slot& slot) { return popWait(slot, nullptr); }
+
+    // 消费者侧, 最多等到 deadline; 超时或 stop() 后队列为空时返回 false, 用 stopped() 区分
+    bool popUntil(Slot& slot, std::chrono::steady_clock::time_point deadline) {
+        return popWait(slot, &deadline);
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopped_ = true;
+        wake_cv_.notify_one();
+    }
+
+    // 让正在等待的消费者立即返回一次 false (stopped() 为 false), 用于处理队列之外的事件
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        interrupted_ = true;
+        wake_cv_.notify_one();
+    }
+
+    bool stopped() {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        return stopped_;
+    }
+
+    size_t size() const {
+        return write_pos_.load(std::memory_order_acquire) -
+               read_pos_.load(std::memory_order_acquire);
+    }
+
+   private:
+    bool popWait(Slot& slot, const std::chrono::steady_clock::time_point* deadline) {
+        for (int i = 0; i < 64; ++i) {
+            if (tryPop(slot)) return true;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (true) {
+            reader_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (tryPop(slot)) {
+                reader_waiting_.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            if (stopped_ || interrupted_) {
+                reader_waiting_.store(false, std::memory_order_relaxed);
+                interrupted_ = false;
+                return false;
+            }
+            // 超时只是兜底, 正常情况下由生产者唤醒
+            auto wake_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+            if (deadline) {
+                if (std::chrono::steady_clock::now() >= *deadline) {
+                    reader_waiting_.store(false, std::memory_order_relaxed);
+                    return false;
+                }
+                wake_at = std::min(wake_at, *deadline);
+            }
+            wake_cv_.wait_until(lock, wake_at);
+        }
+    }
+
+    void wakeReader() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (reader_waiting_.load(std::memory_order_relaxed) &&
+            reader_waiting_.exchange(false, std::memory_order_acq_rel)) {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> write_pos_{0};
+    alignas(64) std::atomic<size_t> read_pos_{0};
+    alignas(64) std::atomic<bool> reader_waiting_{false};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopped_     = false;
+    bool interrupted_ = false;
+};
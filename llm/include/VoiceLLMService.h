@@ -1,22 +1,111 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
-#include "LLMWrapper.h"
+#include "AnswerCache.h"
+#include "LLMBackend.h"
+#include "MessageCoalescer.h"
+#include "RequestScheduler.h"
+#include "SessionManager.h"
+#include "ThinkFilter.h"
+#include "TokenRing.h"
+#include "Utf8Segmenter.h"
 #include "ZmqClient.h"
 #include "ZmqServer.h"
 
 class VoiceLLMService {
    public:
-    VoiceLLMService(const std::string& model_path);
+    VoiceLLMService(const std::string& model_path, std::unique_ptr<LLMBackend> backend,
+                    AnswerCacheConfig cache_config = AnswerCacheConfig(),
+                    SessionConfig session_config   = SessionConfig());
+    ~VoiceLLMService();
+    // 接收线程: 收到请求立即回复并入队, 必要时打断正在进行的生成
     void runForever();
 
    private:
-    void handleCallback(RKLLMResult* result, LLMCallState state);
+    // 推理线程交给发送线程的一轮回答: 生成参数, 回答缓存 key (空表示不写缓存),
+    // 命中缓存时 replay 非空, 发送线程直接重放, 不经过后端.
+    // session_id 非空时回答结束后把 (query, 回答) 追加到会话历史
+    struct AnswerPlan {
+        GenerationParams generation;
+        std::string cache_key;
+        std::shared_ptr<const CachedAnswer> replay;
+        std::string session_id;
+        std::string query;
+    };
+
+    // 推理线程: 按优先级从 scheduler_ 取请求, 逐个调用 llm_->run()
+    void inferenceLoop();
+    // 新请求优先级不低于当前 (或刚结束的) 一轮时打断它: 仍在生成则取消生成,
+    // 已发给 TTS 的内容由发送线程清空. 生成通常比播放早结束很多, 生成已结束时也要清空
+    void bargeIn(int priority);
+    // 推理线程上执行: 只把原始字节写入 token_ring_ 并记录耗时, 不做任何转换和 I/O
+    void handleCallback(const char* text, LLMRunState state);
+    // 发送线程: 从 token_ring_ 取数据, 过滤推理内容, 分句、清洗后经 coalescer_ 发给 TTS
+    void senderLoop();
+    void pushSegment(const std::string& segment);
+    // failed: 后端报错, 回答不完整, 不写入缓存
+    void finishAnswer(bool failed);
+    void replayAnswer();
+    void recordAnswer(const CachedAnswer& answer);
+    void resetAnswer();
+    // 推理线程: 等发送线程处理完已开始的各轮, 会话历史才包含上一轮回答
+    void waitAnswersDone();
+    void sendToTTS(const std::vector<std::string>& batch);
+    // 发送线程: 上一轮已发出 END 但 TTS 还没播放完时发送 <flush>
+    void flushPlayingAnswer();
+
+    void resetCallbackStats();
+    void printCallbackStats() const;
 
    private:
     zmq_component::ZmqServer server_;
     zmq_component::ZmqClient client_;
-    LLMWrapper llm_;
+    std::unique_ptr<LLMBackend> llm_;
+    zmq_component::MessageCoalescer coalescer_;
+
+    RequestScheduler scheduler_;
+    std::thread inference_thread_;
+    std::mutex run_mutex_;  // 保护 in_flight_ / running_priority_ 与轮次切换
+    bool in_flight_       = false;
+    int running_priority_ = kPriorityNormal;
+
+    TokenRing token_ring_;
+    std::thread sender_thread_;
+    ThinkFilter think_filter_;
+    std::string visible_;  // think_filter_ 输出缓冲, 发送线程复用
+    text_segmenter::Utf8Segmenter segmenter_;
+
+    // 按句数提前结束: 推理线程在 run() 前把本轮参数排队, 发送线程处理到该轮时取出.
+    // 发送线程判定说够句数后记下轮次, 由推理线程在该轮的下一次回调里 cancel(),
+    // 保证不会误停已经开始的下一轮
+    std::mutex plans_mutex_;
+    std::deque<AnswerPlan> pending_plans_;
+    std::condition_variable answers_done_cond_;
+    int64_t answers_done_ = 0;  // 发送线程已处理完的轮数, 由 plans_mutex_ 保护
+    AnswerPlan answer_plan_;    // 发送线程当前处理的这一轮
+    bool answer_started_ = false;
+    bool answer_closed_  = false;     // 已达句数上限, 丢弃本轮剩余输出
+    int64_t answer_index_ = 0;        // 发送线程处理到第几轮
+    std::atomic<int64_t> run_index_{-1};
+    std::atomic<int64_t> stop_index_{-1};
+    std::atomic<int64_t> barge_in_index_{-1};  // 被打断的轮次, 丢弃输出并清空 TTS
+    std::atomic<bool> flush_playing_{false};   // 生成结束后被打断, 由发送线程查询 TTS 后清空
+
+    AnswerCache answer_cache_;
+    CachedAnswer answer_record_;  // 发送线程记录本轮发给 TTS 的分句, 结束后写入缓存和会话
+    SessionManager sessions_;
 
-    std::wstring buffer_;
+    // 回调统计, 由回调线程写入, run() 返回后由推理线程读取
+    std::atomic<uint64_t> cb_count_{0};
+    std::atomic<uint64_t> cb_total_ns_{0};
+    std::atomic<uint64_t> cb_max_ns_{0};
+    std::atomic<uint64_t> ring_max_depth_{0};
+    std::atomic<uint64_t> ring_full_waits_{0};
 };
@@ -0,0 +1,115 @@
+#include "AnswerCache.h"
+
+#include <cctype>
+#include <cstring>
+#include <functional>
+
+// 问题中不影响语义的全角标点
+static const char* kWidePunctuation[] = {"，", "。", "！", "？", "、", "；", "：", "“", "”",
+                                         "‘", "’", "（", "）", "【", "】", "《", "》", "…",
+                                         "～", "　"};
+
+static size_t utf8SequenceLength(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead >> 5) == 0x6) return 2;
+    if ((lead >> 4) == 0xE) return 3;
+    if ((lead >> 3) == 0x1E) return 4;
+    return 1;
+}
+
+AnswerCache::AnswerCache(AnswerCacheConfig config) : config_(config) {}
+
+std::string AnswerCache::normalizeQuery(const std::string& query) {
+    std::string normalized;
+    normalized.reserve(query.size());
+
+    size_t i = 0;
+    while (i < query.size()) {
+        unsigned char c = static_cast<unsigned char>(query[i]);
+        if (c < 0x80) {
+            if (!std::isspace(c) && !std::ispunct(c))
+                normalized += static_cast<char>(std::tolower(c));
+            ++i;
+            continue;
+        }
+
+        size_t length = utf8SequenceLength(c);
+        if (i + length > query.size()) break;
+
+        bool punctuation = false;
+        for (const char* wide : kWidePunctuation) {
+            if (std::strlen(wide) == length && query.compare(i, length, wide) == 0) {
+                punctuation = true;
+                break;
+            }
+        }
+        if (!punctuation) normalized.append(query, i, length);
+        i += length;
+    }
+    return normalized;
+}
+
+std::string AnswerCache::makeKey(const RagRequest& request) {
+    if (!request.cacheable) return "";
+
+    std::string query = normalizeQuery(request.query);
+    if (query.empty()) return "";
+
+    // 同一问题在不同检索内容或生成预算下回答不同, 都要进 key
+    return query + "\x1f" + std::to_string(std::hash<std::string>()(request.rag)) + "\x1f" +
+           std::to_string(request.generation.max_new_tokens) + "\x1f" +
+           std::to_string(request.generation.max_sentences);
+}
+
+std::shared_ptr<const CachedAnswer> AnswerCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    if (config_.ttl_seconds > 0 &&
+        Clock::now() - it->second->stored > std::chrono::seconds(config_.ttl_seconds)) {
+        entries_.erase(it->second);
+        index_.erase(it);
+        ++misses_;
+        return nullptr;
+    }
+
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++hits_;
+    return it->second->answer;
+}
+
+void AnswerCache::insert(const std::string& key, CachedAnswer answer) {
+    if (!enabled() || key.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    entries_.push_front({key, std::make_shared<const CachedAnswer>(std::move(answer)),
+                         Clock::now()});
+    index_[key] = entries_.begin();
+
+    while (entries_.size() > config_.capacity) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
+
+size_t AnswerCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t AnswerCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
@@ -0,0 +1,46 @@
+#include "LLMBackend.h"
+
+#include "MockBackend.h"
+#ifdef LLM_WITH_RKLLM
+#include "RkllmBackend.h"
+#endif
+#ifdef LLM_WITH_LLAMACPP
+#include "LlamaCppBackend.h"
+#endif
+
+void LLMBackend::setSystemPrompt(const std::vector<PromptPart>& parts) {
+    std::string prompt;
+    for (const auto& part : parts) prompt += part.text;
+    setChatTemplate(prompt);
+}
+
+void LLMBackend::setHistory(const std::string& /*session_id*/,
+                            const std::vector<ChatTurn>& /*turns*/) {}
+
+std::unique_ptr<LLMBackend> createLLMBackend(const std::string& type,
+                                             const LLMBackendOptions& options) {
+    std::string selected = type;
+    if (selected.empty()) selected = availableLLMBackends().front();
+
+#ifdef LLM_WITH_RKLLM
+    if (selected == "rkllm") return std::make_unique<RkllmBackend>();
+#endif
+#ifdef LLM_WITH_LLAMACPP
+    if (selected == "llama") return std::make_unique<LlamaCppBackend>(options.cpu_threads);
+#endif
+    if (selected == "mock") return std::make_unique<MockBackend>(options.mock_tokens_per_second);
+    return nullptr;
+}
+
+std::vector<std::string> availableLLMBackends() {
+    // 按优先级排列, 第一个为默认后端
+    std::vector<std::string> names;
+#ifdef LLM_WITH_RKLLM
+    names.push_back("rkllm");
+#endif
+#ifdef LLM_WITH_LLAMACPP
+    names.push_back("llama");
+#endif
+    names.push_back("mock");
+    return names;
+}
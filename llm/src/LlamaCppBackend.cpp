@@ -0,0 +1,283 @@
+#include "LlamaCppBackend.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include "llama.h"
+
+LlamaCppBackend::LlamaCppBackend(int n_threads, size_t max_prefix_cache_entries)
+    : n_threads_(n_threads), max_prefix_entries_(max_prefix_cache_entries) {}
+
+LlamaCppBackend::~LlamaCppBackend() {
+    if (sampler_) llama_sampler_free(sampler_);
+    if (ctx_) llama_free(ctx_);
+    if (model_) llama_model_free(model_);
+}
+
+bool LlamaCppBackend::init(const std::string& model_path) {
+    llama_backend_init();
+
+    llama_model_params model_params = llama_model_default_params();
+    model_params.n_gpu_layers       = 0;
+    model_                          = llama_model_load_from_file(model_path.c_str(), model_params);
+    if (!model_) {
+        std::cerr << "llama.cpp load model failed: " << model_path << std::endl;
+        return false;
+    }
+
+    // 与 rkllm 后端保持相同的上下文和生成长度, 性能数据才有可比性
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx                = max_context_len_;
+    ctx_params.n_batch              = max_context_len_;
+    ctx_params.n_threads            = n_threads_;
+    ctx_params.n_threads_batch      = n_threads_;
+    ctx_                            = llama_init_from_model(model_, ctx_params);
+    if (!ctx_) {
+        std::cerr << "llama.cpp create context failed" << std::endl;
+        return false;
+    }
+
+    sampler_ = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    llama_sampler_chain_add(sampler_, llama_sampler_init_greedy());
+    return true;
+}
+
+void LlamaCppBackend::setChatTemplate(const std::string& system_prompt) {
+    system_parts_.clear();
+    if (!system_prompt.empty()) system_parts_.push_back({"", system_prompt});
+    system_prompt_ = system_prompt;
+}
+
+void LlamaCppBackend::setSystemPrompt(const std::vector<PromptPart>& parts) {
+    system_parts_ = parts;
+    system_prompt_.clear();
+    for (const auto& part : parts) system_prompt_ += part.text;
+}
+
+void LlamaCppBackend::setHistory(const std::string& /*session_id*/,
+                                 const std::vector<ChatTurn>& turns) {
+    // 每一轮都按内容进入前缀 key, 不需要区分会话
+    history_ = turns;
+}
+
+std::string LlamaCppBackend::renderChat(size_t n_turns, const std::string* user_input) const {
+    std::vector<llama_chat_message> messages;
+    if (!system_prompt_.empty()) messages.push_back({"system", system_prompt_.c_str()});
+    for (size_t i = 0; i < n_turns && i < history_.size(); ++i) {
+        messages.push_back({"user", history_[i].user.c_str()});
+        messages.push_back({"assistant", history_[i].assistant.c_str()});
+    }
+    if (user_input) messages.push_back({"user", user_input->c_str()});
+    bool add_ass = user_input != nullptr;
+
+    const char* tmpl = llama_model_chat_template(model_, nullptr);
+    std::vector<char> buf(4096);
+    int n = llama_chat_apply_template(tmpl, messages.data(), messages.size(), add_ass, buf.data(),
+                                      static_cast<int32_t>(buf.size()));
+    if (n > static_cast<int>(buf.size())) {
+        buf.resize(n);
+        n = llama_chat_apply_template(tmpl, messages.data(), messages.size(), add_ass, buf.data(),
+                                      static_cast<int32_t>(buf.size()));
+    }
+    if (n < 0) {
+        // 模型没有可识别的模板时退回到简单拼接
+        std::string prompt = system_prompt_ + "\n";
+        for (size_t i = 0; i < n_turns && i < history_.size(); ++i)
+            prompt += history_[i].user + "\n" + history_[i].assistant + "\n";
+        if (user_input) prompt += *user_input + "\n";
+        return prompt;
+    }
+    return std::string(buf.data(), n);
+}
+
+std::vector<int32_t> LlamaCppBackend::tokenize(const std::string& text, bool add_special) const {
+    const llama_vocab* vocab = llama_model_get_vocab(model_);
+    int n = -llama_tokenize(vocab, text.c_str(), static_cast<int32_t>(text.size()), nullptr, 0,
+                            add_special, true);
+    std::vector<int32_t> tokens(std::max(n, 0));
+    llama_tokenize(vocab, text.c_str(), static_cast<int32_t>(text.size()), tokens.data(), n,
+                   add_special, true);
+    return tokens;
+}
+
+std::string LlamaCppBackend::detokenize(const std::vector<int32_t>& tokens, size_t from) const {
+    const llama_vocab* vocab = llama_model_get_vocab(model_);
+    std::string text;
+    char piece[256];
+    for (size_t i = from; i < tokens.size(); ++i) {
+        int n = llama_token_to_piece(vocab, tokens[i], piece, sizeof(piece), 0, false);
+        if (n > 0) text.append(piece, n);
+    }
+    // 字节级分词时截断点可能落在多字节字符中间
+    size_t skip = 0;
+    while (skip < text.size() && (static_cast<unsigned char>(text[skip]) & 0xC0) == 0x80) ++skip;
+    return text.substr(skip);
+}
+
+bool LlamaCppBackend::decode(std::vector<int32_t>& tokens) {
+    if (tokens.empty()) return true;
+    llama_batch batch = llama_batch_get_one(tokens.data(), static_cast<int32_t>(tokens.size()));
+    return llama_decode(ctx_, batch) == 0;
+}
+
+LlamaCppBackend::PrefixCacheEntry* LlamaCppBackend::findPrefix(const std::string& key) {
+    for (auto& entry : prefix_cache_) {
+        if (entry.key == key) return &entry;
+    }
+    return nullptr;
+}
+
+void LlamaCppBackend::savePrefix(const std::string& key, size_t n_tokens) {
+    if (max_prefix_entries_ == 0 || findPrefix(key)) return;
+
+    PrefixCacheEntry entry;
+    entry.key      = key;
+    entry.n_tokens = n_tokens;
+    entry.state.resize(llama_state_seq_get_size(ctx_, 0));
+    entry.state.resize(llama_state_seq_get_data(ctx_, entry.state.data(), entry.state.size(), 0));
+    entry.last_used = ++use_counter_;
+
+    // 淘汰最久未用的条目
+    if (prefix_cache_.size() >= max_prefix_entries_) {
+        auto lru = std::min_element(prefix_cache_.begin(), prefix_cache_.end(),
+                                    [](const PrefixCacheEntry& a, const PrefixCacheEntry& b) {
+                                        return a.last_used < b.last_used;
+                                    });
+        *lru = std::move(entry);
+    } else {
+        prefix_cache_.push_back(std::move(entry));
+    }
+}
+
+void LlamaCppBackend::run(const std::string& user_input, const GenerationParams& params,
+                          const Callback& callback) {
+    cancelled_ = false;
+    if (!ctx_) {
+        callback("", LLMRunState::ERROR);
+        return;
+    }
+
+    llama_memory_t memory = llama_get_memory(ctx_);
+    llama_sampler_reset(sampler_);
+
+    // 按系统提示词片段和历史轮次把渲染后的提示词切成多级前缀:
+    // 模板头 + part0, part1, ..., turn0, turn1, ..., 本轮输入.
+    // 模板改写了系统提示词导致找不到原文时整段 prefill, 不做缓存
+    std::string prompt = renderChat(history_.size(), &user_input);
+    std::vector<std::string> pieces;
+    std::vector<std::string> keys;
+    size_t sys_pos = system_prompt_.empty() ? std::string::npos : prompt.find(system_prompt_);
+    size_t offset  = 0;
+    if (sys_pos != std::string::npos) {
+        std::string path;
+        size_t end = sys_pos;
+        for (const auto& part : system_parts_) {
+            end += part.text.size();
+            path = (part.cache_key.empty() || (!keys.empty() && keys.back().empty()))
+                       ? ""
+                       : path + part.cache_key + "|";
+            pieces.push_back(prompt.substr(offset, end - offset));
+            keys.push_back(path);
+            offset = end;
+        }
+    }
+    if (system_prompt_.empty() || sys_pos != std::string::npos) {
+        // 前 k 轮单独渲染的结果是完整提示词的前缀时, 在该处切分. 同一会话的下一轮从上一轮结束处恢复
+        std::string path = keys.empty() ? "" : keys.back();
+        bool chained     = keys.empty() || !path.empty();
+        for (size_t k = 1; k <= history_.size(); ++k) {
+            std::string rendered = renderChat(k, nullptr);
+            if (rendered.size() <= offset || prompt.compare(0, rendered.size(), rendered) != 0)
+                break;
+
+            const ChatTurn& turn = history_[k - 1];
+            size_t turn_hash     = std::hash<std::string>()(turn.user + "\x1f" + turn.assistant);
+            path = chained ? path + "turn#" + std::to_string(turn_hash) + "|" : "";
+            pieces.push_back(prompt.substr(offset, rendered.size() - offset));
+            keys.push_back(path);
+            offset = rendered.size();
+        }
+    }
+    pieces.push_back(prompt.substr(offset));
+    keys.push_back("");
+
+    // 从最长的已缓存前缀恢复
+    size_t start    = 0;
+    size_t n_past   = 0;
+    size_t n_reused = 0;
+    llama_memory_clear(memory, true);
+    for (size_t i = keys.size(); i-- > 0;) {
+        if (keys[i].empty()) continue;
+        PrefixCacheEntry* entry = findPrefix(keys[i]);
+        if (!entry) continue;
+        if (llama_state_seq_set_data(ctx_, entry->state.data(), entry->state.size(), 0) == 0) {
+            llama_memory_clear(memory, true);
+            break;
+        }
+        entry->last_used = ++use_counter_;
+        start            = i + 1;
+        n_past           = entry->n_tokens;
+        n_reused         = n_past;
+        break;
+    }
+
+    // prefill 剩余部分, 带 key 的前缀完成后保存状态
+    for (size_t i = start; i < pieces.size(); ++i) {
+        std::vector<int32_t> tokens = tokenize(pieces[i], i == 0);
+        if (i + 1 == pieces.size()) {
+            // 超出上下文时截掉本轮输入的开头再重新套模板, 不能直接截 token 序列,
+            // 否则会截掉模板的 user 头. 截断后重新分词可能多出一两个 token, 再截一次
+            std::string input = user_input;
+            size_t limit      = static_cast<size_t>(max_context_len_);
+            while (n_past + tokens.size() + max_new_tokens_ > limit && !input.empty()) {
+                size_t over = n_past + tokens.size() + max_new_tokens_ - limit;
+                std::vector<int32_t> input_tokens = tokenize(input, false);
+                std::string shorter =
+                    over < input_tokens.size() ? detokenize(input_tokens, over) : "";
+                input = shorter.size() < input.size() ? shorter : "";
+                pieces[i] = renderChat(history_.size(), &input).substr(offset);
+                tokens    = tokenize(pieces[i], i == 0);
+            }
+            if (input.size() < user_input.size()) {
+                std::cout << "[llama] prompt exceeds context, input truncated to: " << input
+                          << std::endl;
+            }
+        }
+        if (!decode(tokens)) {
+            callback("", LLMRunState::ERROR);
+            return;
+        }
+        n_past += tokens.size();
+        if (!keys[i].empty()) savePrefix(keys[i], n_past);
+    }
+    if (n_reused > 0) {
+        std::cout << "[llama] prefix cache hit: reused " << n_reused << " tokens, prefilled "
+                  << n_past - n_reused << std::endl;
+    }
+
+    const llama_vocab* vocab = llama_model_get_vocab(model_);
+    llama_token next         = 0;
+    char piece[256];
+
+    int max_tokens = std::min(params.max_new_tokens, max_new_tokens_);
+    for (int i = 0; i < max_tokens && !cancelled_; ++i) {
+        next = llama_sampler_sample(sampler_, ctx_, -1);
+        if (llama_vocab_is_eog(vocab, next)) break;
+
+        int n = llama_token_to_piece(vocab, next, piece, sizeof(piece) - 1, 0, false);
+        if (n > 0) {
+            piece[n] = '\0';
+            callback(piece, LLMRunState::NORMAL);
+        }
+
+        llama_batch batch = llama_batch_get_one(&next, 1);
+        if (llama_decode(ctx_, batch) != 0) {
+            callback("", LLMRunState::ERROR);
+            return;
+        }
+    }
+    callback("", LLMRunState::FINISH);
+}
+
+void LlamaCppBackend::cancel() { cancelled_ = true; }
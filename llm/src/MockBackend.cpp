@@ -0,0 +1,84 @@
+#include "MockBackend.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+MockBackend::MockBackend(double tokens_per_second, size_t chars_per_token)
+    : tokens_per_second_(tokens_per_second), chars_per_token_(chars_per_token) {}
+
+bool MockBackend::init(const std::string& model_path) {
+    script_.clear();
+    if (!model_path.empty() && model_path != "-") {
+        std::ifstream in(model_path);
+        if (!in) {
+            std::cerr << "mock script not found: " << model_path << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) script_.push_back(line);
+        }
+    }
+
+    if (script_.empty()) {
+        script_ = {
+            "好的，发动机故障灯亮起时，请先靠边停车，检查机油和冷却液液位。如果仍然亮着，"
+            "建议尽快联系售后服务。",
+            "根据手册，车辆每行驶五千公里或六个月需要保养一次，包括更换机油和机油滤清器。",
+            "今天天气不错，适合自驾出行，可以去附近的公园走走，注意安全驾驶。",
+        };
+    }
+    next_answer_ = 0;
+    return true;
+}
+
+void MockBackend::setChatTemplate(const std::string& system_prompt) { (void)system_prompt; }
+
+// 按 UTF-8 码点切分, 每 chars_per_token_ 个字符作为一个 token
+std::vector<std::string> MockBackend::tokenize(const std::string& text) const {
+    std::vector<std::string> tokens;
+    std::string current;
+    size_t chars = 0;
+
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = text[i];
+        size_t len      = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+        current.append(text, i, len);
+        i += len;
+        if (++chars == chars_per_token_) {
+            tokens.push_back(current);
+            current.clear();
+            chars = 0;
+        }
+    }
+    if (!current.empty()) tokens.push_back(current);
+    return tokens;
+}
+
+void MockBackend::run(const std::string& user_input, const GenerationParams& params,
+                      const Callback& callback) {
+    (void)user_input;
+    cancelled_ = false;
+    if (script_.empty()) {
+        callback("", LLMRunState::ERROR);
+        return;
+    }
+
+    const std::string& answer = script_[next_answer_++ % script_.size()];
+    auto interval             = std::chrono::duration<double>(1.0 / tokens_per_second_);
+    auto next                 = std::chrono::steady_clock::now();
+
+    int generated = 0;
+    for (const auto& token : tokenize(answer)) {
+        if (generated++ >= params.max_new_tokens) break;
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+        std::this_thread::sleep_until(next);
+        if (cancelled_) break;
+        callback(token.c_str(), LLMRunState::NORMAL);
+    }
+    callback("", LLMRunState::FINISH);
+}
+
+void MockBackend::cancel() { cancelled_ = true; }
@@ -1,22 +1,76 @@
 #include "RagUtils.h"
 
-std::pair<std::string, std::string> splitRagTag(const std::string& input)
+#include <cstdlib>
+#include <functional>
+
+static const char* kRagPreamble =
+    "你是一款智能座舱 AI 助手：\n"
+    "1. 使用口语化表达\n"
+    "回答必须基于以下内容：\n";
+
+// 取出标签属性 name=value 的值, 不存在时返回空串
+static std::string tagAttribute(const std::string& attrs, const std::string& name)
 {
-    const std::string TAG = "<rag>";
-    size_t pos = input.find(TAG);
+    size_t pos = attrs.find(name + "=");
     if (pos == std::string::npos)
-        return {input, ""};
-    return {input.substr(0, pos), input.substr(pos + TAG.size())};
+        return "";
+    std::string value = attrs.substr(pos + name.size() + 1);
+    return value.substr(0, value.find(' '));
+}
+
+RagRequest parseRagRequest(const std::string& input)
+{
+    RagRequest request;
+    std::string body = input;
+
+    // <gen max_new_tokens=N max_sentences=M priority=P cache=0|1 session=ID>
+    if (body.compare(0, 4, "<gen") == 0 && body.find('>') != std::string::npos) {
+        size_t end        = body.find('>');
+        std::string attrs = body.substr(4, end - 4);
+        std::string value = tagAttribute(attrs, "max_new_tokens");
+        if (!value.empty())
+            request.generation.max_new_tokens = std::atoi(value.c_str());
+        value = tagAttribute(attrs, "max_sentences");
+        if (!value.empty())
+            request.generation.max_sentences = std::atoi(value.c_str());
+        value = tagAttribute(attrs, "priority");
+        if (!value.empty())
+            request.priority = std::atoi(value.c_str());
+        value = tagAttribute(attrs, "cache");
+        if (!value.empty())
+            request.cacheable = value != "0";
+        request.session_id = tagAttribute(attrs, "session");
+        body = body.substr(end + 1);
+    }
+
+    size_t pos = body.find("<rag");
+    size_t end = pos == std::string::npos ? pos : body.find('>', pos);
+    if (end == std::string::npos) {
+        request.query = body;
+        return request;
+    }
+
+    request.query    = body.substr(0, pos);
+    request.rag      = body.substr(end + 1);
+    // <rag id=xxx>
+    request.chunk_id = tagAttribute(body.substr(pos + 4, end - pos - 4), "id");
+    return request;
+}
+
+std::pair<std::string, std::string> splitRagTag(const std::string& input)
+{
+    RagRequest request = parseRagRequest(input);
+    return {request.query, request.rag};
 }
 
 std::string buildRagPrompt(const std::string& rag)
 {
-    std::string prompt =
-        "你是一款智能座舱 AI 助手：\n"
-        "1. 使用口语化表达\n"
-        "回答必须基于以下内容：\n"
-        "{rag_context}";
-
-    size_t p = prompt.find("{rag_context}");
-    return prompt.replace(p, 14, rag);
+    return kRagPreamble + rag;
+}
+
+std::vector<PromptPart> buildRagPromptParts(const std::string& rag, const std::string& chunk_id)
+{
+    std::string chunk_key =
+        "rag:" + chunk_id + "#" + std::to_string(std::hash<std::string>()(rag));
+    return {{"rag_preamble", kRagPreamble}, {chunk_key, rag}};
 }
@@ -0,0 +1,69 @@
+#include "RequestScheduler.h"
+
+#include <algorithm>
+
+RequestScheduler::RequestScheduler(SchedulerConfig config) : config_(config) {
+    if (config_.capacity == 0) config_.capacity = 1;
+}
+
+size_t RequestScheduler::submit(RagRequest request) {
+    size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) return 1;
+
+        int priority = request.priority;
+        if (config_.supersede_same_priority) {
+            size_t before = queue_.size();
+            queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                        [priority](const RagRequest& queued) {
+                                            return queued.priority == priority;
+                                        }),
+                         queue_.end());
+            dropped += before - queue_.size();
+        }
+
+        if (queue_.size() >= config_.capacity) {
+            // 队尾是优先级最低的请求; 同级中最旧的在最前面
+            int lowest = queue_.back().priority;
+            if (priority > lowest) return dropped + 1;
+            auto oldest = std::find_if(queue_.begin(), queue_.end(),
+                                       [lowest](const RagRequest& queued) {
+                                           return queued.priority == lowest;
+                                       });
+            queue_.erase(oldest);
+            ++dropped;
+        }
+
+        auto pos = std::upper_bound(queue_.begin(), queue_.end(), priority,
+                                    [](int value, const RagRequest& queued) {
+                                        return value < queued.priority;
+                                    });
+        queue_.insert(pos, std::move(request));
+    }
+    cond_.notify_one();
+    return dropped;
+}
+
+bool RequestScheduler::pop(RagRequest& request) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !queue_.empty() || stopped_; });
+    if (stopped_) return false;
+
+    request = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+}
+
+void RequestScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    cond_.notify_all();
+}
+
+size_t RequestScheduler::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
@@ -0,0 +1,179 @@
+#include "RkllmBackend.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+#include "Utf8Segmenter.h"
+
+// 单次 rkllm_run 的回调上下文, 经 userdata 传入
+struct RkllmRunContext {
+    const LLMBackend::Callback* callback;
+    LLMHandle handle;
+    int max_new_tokens;
+    int generated;
+    bool finished;  // 已回调 FINISH 或 ERROR
+    bool failed;
+};
+
+static int GlobalCallback(RKLLMResult* result, void* userdata, LLMCallState state) {
+    // 将回调内容转发给userdata
+    auto ctx = reinterpret_cast<RkllmRunContext*>(userdata);
+    if (!ctx || ctx->finished) return 0;
+
+    if (state == RKLLM_RUN_NORMAL) {
+        // max_new_tokens 在 rkllm_init 时固定, 单次请求的上限在这里计数后中止
+        if (ctx->generated >= ctx->max_new_tokens) return 0;
+        (*ctx->callback)(result->text, LLMRunState::NORMAL);
+        if (++ctx->generated >= ctx->max_new_tokens) rkllm_abort(ctx->handle);
+    } else if (state == RKLLM_RUN_FINISH) {
+        ctx->finished = true;
+        (*ctx->callback)("", LLMRunState::FINISH);
+    } else if (state == RKLLM_RUN_ERROR) {
+        ctx->finished = true;
+        ctx->failed   = true;
+        (*ctx->callback)("", LLMRunState::ERROR);
+    }
+    return 0;
+}
+
+RkllmBackend::~RkllmBackend() {
+    if (handle_) {
+        rkllm_destroy(handle_);
+    }
+}
+
+bool RkllmBackend::init(const std::string& model_path) {
+    RKLLMParam param         = rkllm_createDefaultParam();
+    param.model_path         = model_path.c_str();
+    param.max_new_tokens     = 100;
+    param.max_context_len    = max_context_len_;
+    param.skip_special_token = true;
+
+    int ret = rkllm_init(&handle_, &param, GlobalCallback);
+    if (ret != 0) {
+        std::cerr << "rkllm init failed\n";
+        handle_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void RkllmBackend::setChatTemplate(const std::string& system_prompt) {
+    rkllm_set_chat_template(handle_, system_prompt.c_str(), "<｜User｜>",
+                            "<｜Assistant｜><think>\n</think>");
+    system_prompt_ = system_prompt;
+    system_prompt_key_.clear();
+    reuse_system_prompt_ = false;
+    prompt_changed_      = true;
+}
+
+void RkllmBackend::setSystemPrompt(const std::vector<PromptPart>& parts) {
+    std::string key;
+    std::string prompt;
+    for (const auto& part : parts) {
+        if (part.cache_key.empty()) {
+            key.clear();
+            break;
+        }
+        key += part.cache_key + "|";
+    }
+    for (const auto& part : parts) prompt += part.text;
+
+    // rkllm 只保留一份系统提示词的 KV cache, 相当于容量为 1 的前缀缓存
+    if (key == system_prompt_key_ && prompt == system_prompt_) {
+        reuse_system_prompt_ = !key.empty();
+        return;
+    }
+    setChatTemplate(prompt);
+    system_prompt_key_ = key;
+}
+
+static bool sameTurn(const ChatTurn& a, const ChatTurn& b) {
+    return a.user == b.user && a.assistant == b.assistant;
+}
+
+// 运行时不接受多轮消息, 不能复用时把历史作为文本放在本轮输入前面
+static std::string renderHistory(const std::vector<ChatTurn>& turns) {
+    std::string text = "之前的对话：\n";
+    for (const auto& turn : turns) {
+        text += "用户：" + turn.user + "\n助手：" + turn.assistant + "\n";
+    }
+    return text + "现在的问题：";
+}
+
+void RkllmBackend::setHistory(const std::string& session_id, const std::vector<ChatTurn>& turns) {
+    // KV 中正好是 "上一轮的历史 + 上一轮问答" 时, 本轮的历史与之相同, 可以直接接着说
+    resume_ = !session_id.empty() && session_id == kv_session_ && !prompt_changed_ &&
+              turns.size() == kv_history_.size() + 1 &&
+              std::equal(kv_history_.begin(), kv_history_.end(), turns.begin(), sameTurn) &&
+              turns.back().user == kv_last_user_;
+    session_id_ = session_id;
+    history_    = turns;
+}
+
+void RkllmBackend::run(const std::string& user_input, const GenerationParams& params,
+                       const Callback& callback) {
+    // 保留的对话加上本轮会超出上下文时放弃复用
+    size_t input_tokens = text_segmenter::utf8_length(user_input);
+    if (resume_ && kv_tokens_ + input_tokens + params.max_new_tokens >
+                       static_cast<size_t>(max_context_len_)) {
+        resume_ = false;
+    }
+
+    std::string prompt = user_input;
+    if (!resume_ && !history_.empty()) prompt = renderHistory(history_) + user_input;
+
+    RKLLMInput input;
+    memset(&input, 0, sizeof(input));
+    input.input_type   = RKLLM_INPUT_PROMPT;
+    input.prompt_input = (char*)prompt.c_str();
+
+    RKLLMInferParam infer;
+    memset(&infer, 0, sizeof(infer));
+    infer.mode = RKLLM_INFER_GENERATE;
+
+    // 可复用时清掉上一轮的对话部分, 只保留系统提示词的 KV, 本轮从用户输入开始 prefill.
+    // keep_history = 1 使系统提示词 (和会话的对话) 留在 KV cache 中供下一轮复用
+    if (resume_) {
+        std::cout << "[rkllm] resume session " << session_id_ << " (" << kv_tokens_
+                  << " tokens kept)" << std::endl;
+    } else if (reuse_system_prompt_) {
+        rkllm_clear_kv_cache(handle_, 1, nullptr, nullptr);
+        std::cout << "[rkllm] reuse system prompt KV cache" << std::endl;
+    } else {
+        rkllm_clear_kv_cache(handle_, 0, nullptr, nullptr);
+    }
+    infer.keep_history = (system_prompt_key_.empty() && session_id_.empty()) ? 0 : 1;
+    reuse_system_prompt_ = false;
+    prompt_changed_      = false;
+
+    RkllmRunContext ctx{&callback, handle_, params.max_new_tokens, 0, false, false};
+    rkllm_run(handle_, &input, &infer, &ctx);
+
+    // 被中止时运行时不一定回调 FINISH, 这里补发保证调用方恰好收到一次
+    if (!ctx.finished) callback("", LLMRunState::FINISH);
+
+    // 记下 KV 中的对话, 下一轮判断能否接着说
+    if (session_id_.empty() || ctx.failed) {
+        kv_session_.clear();
+        kv_history_.clear();
+        kv_tokens_ = 0;
+    } else {
+        if (!resume_) kv_tokens_ = text_segmenter::utf8_length(system_prompt_);
+        kv_tokens_ += text_segmenter::utf8_length(prompt) + ctx.generated;
+        kv_session_   = session_id_;
+        kv_history_   = history_;
+        kv_last_user_ = user_input;
+    }
+    resume_ = false;
+    session_id_.clear();
+    history_.clear();
+}
+
+void RkllmBackend::cancel() {
+    if (handle_) {
+        rkllm_abort(handle_);
+    }
+}
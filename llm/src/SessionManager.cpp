@@ -0,0 +1,88 @@
+#include "SessionManager.h"
+
+#include "Utf8Segmenter.h"
+
+SessionManager::SessionManager(SessionConfig config) : config_(config) {}
+
+size_t SessionManager::estimateTokens(const ChatTurn& turn) {
+    return text_segmenter::utf8_length(turn.user) + text_segmenter::utf8_length(turn.assistant);
+}
+
+bool SessionManager::expired(const Session& session) const {
+    return config_.idle_timeout_seconds > 0 &&
+           Clock::now() - session.last_used > std::chrono::seconds(config_.idle_timeout_seconds);
+}
+
+void SessionManager::eraseLocked(std::list<Session>::iterator it) {
+    total_tokens_ -= it->tokens;
+    index_.erase(it->id);
+    sessions_.erase(it);
+}
+
+std::vector<ChatTurn> SessionManager::history(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(session_id);
+    if (it == index_.end()) return {};
+    if (expired(*it->second)) {
+        eraseLocked(it->second);
+        return {};
+    }
+    return it->second->turns;
+}
+
+void SessionManager::append(const std::string& session_id, ChatTurn turn) {
+    if (session_id.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(session_id);
+    if (it != index_.end() && expired(*it->second)) {
+        eraseLocked(it->second);
+        it = index_.end();
+    }
+    if (it == index_.end()) {
+        sessions_.push_front(Session());
+        sessions_.front().id = session_id;
+        index_[session_id]   = sessions_.begin();
+    } else {
+        sessions_.splice(sessions_.begin(), sessions_, it->second);
+    }
+
+    Session& session  = sessions_.front();
+    session.last_used = Clock::now();
+    size_t tokens     = estimateTokens(turn);
+    session.turns.push_back(std::move(turn));
+    session.tokens += tokens;
+    total_tokens_ += tokens;
+
+    // 单个会话超出预算时丢弃最早的轮次, 至少保留刚说完的这一轮
+    while (session.turns.size() > 1 && session.tokens > config_.max_history_tokens) {
+        size_t dropped = estimateTokens(session.turns.front());
+        session.turns.erase(session.turns.begin());
+        session.tokens -= dropped;
+        total_tokens_ -= dropped;
+    }
+
+    // 总量超出时淘汰最久未用的其他会话
+    while (total_tokens_ > config_.max_total_tokens && sessions_.size() > 1) {
+        eraseLocked(std::prev(sessions_.end()));
+    }
+}
+
+void SessionManager::erase(const std::string& session_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(session_id);
+    if (it != index_.end()) eraseLocked(it->second);
+}
+
+size_t SessionManager::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+size_t SessionManager::totalTokens() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_tokens_;
+}
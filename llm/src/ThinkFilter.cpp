@@ -0,0 +1,64 @@
+#include "ThinkFilter.h"
+
+static const std::string kOpenTag  = "<think>";
+static const std::string kCloseTag = "</think>";
+
+ThinkFilter::ThinkFilter(bool start_inside) : start_inside_(start_inside), inside_(start_inside) {}
+
+void ThinkFilter::feed(const char* data, size_t length, std::string& out) {
+    for (size_t i = 0; i < length; ++i) {
+        char c = data[i];
+        const std::string& tag = inside_ ? kCloseTag : kOpenTag;
+
+        if (pending_.empty() && c != '<') {
+            if (inside_) {
+                ++dropped_bytes_;
+            } else {
+                out += c;
+            }
+            continue;
+        }
+
+        pending_ += c;
+        if (tag.compare(0, pending_.size(), pending_) == 0) {
+            if (pending_.size() == tag.size()) {
+                dropped_bytes_ += pending_.size();
+                pending_.clear();
+                inside_ = !inside_;
+            }
+            continue;
+        }
+
+        // 匹配失败. 标签里只有开头一个 '<', 失败时只有当前字节可能是新标签的开始
+        std::string flushed = pending_.substr(0, pending_.size() - 1);
+        pending_.erase(0, pending_.size() - 1);
+        if (inside_) {
+            dropped_bytes_ += flushed.size();
+        } else {
+            out += flushed;
+        }
+        if (c != '<') {
+            if (inside_) {
+                ++dropped_bytes_;
+            } else {
+                out += c;
+            }
+            pending_.clear();
+        }
+    }
+}
+
+void ThinkFilter::finish(std::string& out) {
+    if (inside_) {
+        dropped_bytes_ += pending_.size();
+    } else {
+        out += pending_;
+    }
+    pending_.clear();
+}
+
+void ThinkFilter::reset() {
+    inside_ = start_inside_;
+    pending_.clear();
+    dropped_bytes_ = 0;
+}
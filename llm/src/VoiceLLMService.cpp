@@ -1,56 +1,357 @@
 #include "VoiceLLMService.h"
 
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
 
 #include "RagUtils.h"
-#include "TextUtils.h"
-
-VoiceLLMService::VoiceLLMService(const std::string& model)
-    : server_("tcp://*:8899"), client_("tcp://localhost:7777"), llm_(model) {}
-
-void VoiceLLMService::handleCallback(RKLLMResult* result, LLMCallState state) {
-    if (state == RKLLM_RUN_NORMAL) {
-        std::wstring ws = utf8_to_wstring(result->text);
-        for (wchar_t c : ws) {
-            buffer_ += c;
-            if (is_split_punctuation(c)) {
-                std::string send     = wstring_to_utf8(extract_after_think(buffer_));
-                std::string response = client_.request(send);
-                std::cout << "[tts -> llm] received: " << response << std::endl;
-                buffer_.clear();
+
+// 打断后通知 TTS 丢弃尚未播放的内容, 取代本轮的 END
+static const char* kFlushFrame = "<flush>";
+// 查询 TTS 是否还有已收到 END 但没播放完的回答, 回复 "playing" 或 "idle"
+static const char* kStatusFrame = "<status>";
+
+// 按中文标点分句, 并去掉 TTS 不需要朗读的标点和 markdown 符号
+static text_segmenter::SegmenterConfig tts_segmenter_config() {
+    text_segmenter::SegmenterConfig config;
+    config.delimiters  = "：，。\n；！？";
+    config.strip_chars = " \t\n\r*#@$%^&，。：、；！？【】（）“”‘’";
+    return config;
+}
+
+VoiceLLMService::VoiceLLMService(const std::string& model_path,
+                                 std::unique_ptr<LLMBackend> backend,
+                                 AnswerCacheConfig cache_config, SessionConfig session_config)
+    : server_("tcp://*:8899"),
+      client_("tcp://localhost:7777"),
+      llm_(std::move(backend)),
+      coalescer_([this](const std::vector<std::string>& batch) { sendToTTS(batch); }),
+      segmenter_(tts_segmenter_config()),
+      answer_cache_(cache_config),
+      sessions_(session_config) {
+    if (!llm_->init(model_path)) {
+        std::cerr << "[" << llm_->name() << "] init failed: " << model_path << std::endl;
+    }
+    sender_thread_    = std::thread(&VoiceLLMService::senderLoop, this);
+    inference_thread_ = std::thread(&VoiceLLMService::inferenceLoop, this);
+}
+
+VoiceLLMService::~VoiceLLMService() {
+    scheduler_.stop();
+    llm_->cancel();
+    if (inference_thread_.joinable()) inference_thread_.join();
+    token_ring_.stop();
+    if (sender_thread_.joinable()) sender_thread_.join();
+}
+
+void VoiceLLMService::sendToTTS(const std::vector<std::string>& batch) {
+    std::string response = client_.request(batch);
+    std::cout << "[tts -> llm] received: " << response << " (" << batch.size() << " fragments)"
+              << std::endl;
+}
+
+void VoiceLLMService::flushPlayingAnswer() {
+    std::string status = client_.request(kStatusFrame);
+    if (status != "playing") return;
+    sendToTTS({kFlushFrame});
+    std::cout << "[llm] barge-in after generation finished, flush TTS" << std::endl;
+}
+
+void VoiceLLMService::handleCallback(const char* text, LLMRunState state) {
+    auto start = std::chrono::steady_clock::now();
+
+    // 发送线程要求停止本轮生成
+    int64_t run = run_index_.load(std::memory_order_relaxed);
+    if (stop_index_.load(std::memory_order_relaxed) == run &&
+        stop_index_.compare_exchange_strong(run, -1)) {
+        llm_->cancel();
+    }
+
+    size_t waits = token_ring_.push(text, text ? std::strlen(text) : 0, state);
+    if (waits) ring_full_waits_.fetch_add(waits, std::memory_order_relaxed);
+
+    uint64_t depth = token_ring_.size();
+    if (depth > ring_max_depth_.load(std::memory_order_relaxed))
+        ring_max_depth_.store(depth, std::memory_order_relaxed);
+
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    cb_count_.fetch_add(1, std::memory_order_relaxed);
+    cb_total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > cb_max_ns_.load(std::memory_order_relaxed))
+        cb_max_ns_.store(ns, std::memory_order_relaxed);
+}
+
+void VoiceLLMService::pushSegment(const std::string& segment) {
+    if (answer_closed_ || barge_in_index_.load() == answer_index_) return;
+    coalescer_.push(segment);
+    if (!answer_plan_.cache_key.empty() || !answer_plan_.session_id.empty())
+        answer_record_.segments.push_back(segment);
+
+    // 说够句数后停止生成, 之后到达的输出全部丢弃直到本轮 FINISH
+    int max_sentences = answer_plan_.generation.max_sentences;
+    if (max_sentences > 0 && segmenter_.sentenceCount() >= static_cast<size_t>(max_sentences)) {
+        answer_closed_ = true;
+        stop_index_.store(answer_index_);
+        std::cout << "[llm] " << max_sentences << " sentences spoken, stop generation"
+                  << std::endl;
+    }
+}
+
+void VoiceLLMService::senderLoop() {
+    auto sink = [this](const std::string& segment) { pushSegment(segment); };
+
+    // 槽位边界可能落在标签或多字节字符中间, 由过滤器和分句器各自保留状态.
+    // <think> 内容在分句之前丢弃, 不会产生 TTS 请求.
+    // 有暂存片段时最多等到合并期限, 生成停顿 (解码慢) 时也按期发出
+    TokenRing::Slot slot;
+    while (true) {
+        std::chrono::steady_clock::time_point deadline;
+        bool popped = coalescer_.deadline(deadline) ? token_ring_.popUntil(slot, deadline)
+                                                    : token_ring_.pop(slot);
+        // 先于新一轮的输出处理: 上一轮生成已结束, 但可能还在播放
+        if (flush_playing_.exchange(false)) flushPlayingAnswer();
+        if (!popped) {
+            if (token_ring_.stopped()) break;
+            if (barge_in_index_.load() != answer_index_) coalescer_.poll();
+            continue;
+        }
+
+        if (!answer_started_) {
+            std::lock_guard<std::mutex> lock(plans_mutex_);
+            if (!pending_plans_.empty()) {
+                answer_plan_ = std::move(pending_plans_.front());
+                pending_plans_.pop_front();
             }
+            answer_started_ = true;
         }
-    } else if (state == RKLLM_RUN_FINISH) {
-        if (!buffer_.empty()) {
-            std::string send     = wstring_to_utf8(extract_after_think(buffer_)) + "END";
-            std::string response = client_.request(send);
-            std::cout << "[tts -> llm] received: " << response << std::endl;
-            buffer_.clear();
-        } else {
-            std::string response = client_.request("END");
-            std::cout << "[tts -> llm] received: " << response << std::endl;
+
+        if (!answer_plan_.replay && !answer_closed_ &&
+            barge_in_index_.load() != answer_index_) {
+            visible_.clear();
+            think_filter_.feed(slot.data, slot.length, visible_);
+            segmenter_.feed(visible_, sink);
+        }
+        // ERROR 也按本轮结束处理, 保证 TTS 收到 END
+        if (slot.state != LLMRunState::NORMAL) {
+            if (answer_plan_.replay && barge_in_index_.load() != answer_index_)
+                replayAnswer();
+            else
+                finishAnswer(slot.state == LLMRunState::ERROR);
         }
     }
 }
 
-void VoiceLLMService::runForever() {
+void VoiceLLMService::replayAnswer() {
+    for (const auto& segment : answer_plan_.replay->segments) coalescer_.push(segment);
+    coalescer_.push(answer_plan_.replay->tail + "END");
+    coalescer_.flush();
+    coalescer_.reset();
+    recordAnswer(*answer_plan_.replay);
+    resetAnswer();
+}
+
+void VoiceLLMService::finishAnswer(bool failed) {
+    if (barge_in_index_.load() == answer_index_) {
+        // 被打断: 丢弃未发出的内容, 让 TTS 清空队列, 不再发送 END
+        think_filter_.reset();
+        segmenter_.reset();
+        coalescer_.reset();
+        sendToTTS({kFlushFrame});
+        std::cout << "[llm] answer " << answer_index_ << " interrupted, flush TTS" << std::endl;
+        resetAnswer();
+        return;
+    }
+
+    auto sink = [this](const std::string& segment) { pushSegment(segment); };
+    visible_.clear();
+    think_filter_.finish(visible_);
+    segmenter_.feed(visible_, sink);
+    if (think_filter_.droppedBytes() > 0) {
+        std::cout << "[llm] dropped " << think_filter_.droppedBytes() << " bytes of <think> content"
+                  << std::endl;
+    }
+    think_filter_.reset();
+
+    std::string tail;
+    segmenter_.finish([&tail](const std::string& segment) { tail = segment; });
+    if (answer_closed_) tail.clear();
+
+    coalescer_.push(tail + "END");
+    coalescer_.flush();
+    coalescer_.reset();
+
+    if (!failed) {
+        answer_record_.tail = tail;
+        recordAnswer(answer_record_);
+        if (!answer_plan_.cache_key.empty())
+            answer_cache_.insert(answer_plan_.cache_key, std::move(answer_record_));
+    }
+    resetAnswer();
+}
+
+void VoiceLLMService::recordAnswer(const CachedAnswer& answer) {
+    if (answer_plan_.session_id.empty()) return;
+
+    // 分句时去掉了标点, 按逗号拼回去作为历史
+    ChatTurn turn;
+    turn.user = answer_plan_.query;
+    for (const auto& segment : answer.segments) {
+        if (!turn.assistant.empty()) turn.assistant += "，";
+        turn.assistant += segment;
+    }
+    if (!answer.tail.empty()) {
+        if (!turn.assistant.empty()) turn.assistant += "，";
+        turn.assistant += answer.tail;
+    }
+    if (turn.assistant.empty()) return;
+    turn.assistant += "。";
+
+    sessions_.append(answer_plan_.session_id, std::move(turn));
+}
+
+void VoiceLLMService::resetAnswer() {
+    answer_started_ = false;
+    answer_closed_  = false;
+    answer_plan_    = AnswerPlan();
+    answer_record_  = CachedAnswer();
+    ++answer_index_;
+
+    {
+        std::lock_guard<std::mutex> lock(plans_mutex_);
+        answers_done_ = answer_index_;
+    }
+    answers_done_cond_.notify_all();
+}
+
+void VoiceLLMService::waitAnswersDone() {
+    // 发送线程只做分句和发送, 通常在 run() 返回后几毫秒内处理完; 超时则不带上一轮继续
+    int64_t started = run_index_.load();
+    std::unique_lock<std::mutex> lock(plans_mutex_);
+    answers_done_cond_.wait_for(lock, std::chrono::seconds(1),
+                                [&] { return answers_done_ > started; });
+}
+
+void VoiceLLMService::resetCallbackStats() {
+    cb_count_        = 0;
+    cb_total_ns_     = 0;
+    cb_max_ns_       = 0;
+    ring_max_depth_  = 0;
+    ring_full_waits_ = 0;
+}
+
+void VoiceLLMService::printCallbackStats() const {
+    uint64_t count = cb_count_.load();
+    uint64_t avg   = count ? cb_total_ns_.load() / count : 0;
+    std::cout << "[llm stats] callbacks=" << count << " avg=" << avg / 1000.0
+              << "us max=" << cb_max_ns_.load() / 1000.0
+              << "us ring_max_depth=" << ring_max_depth_.load()
+              << " ring_full_waits=" << ring_full_waits_.load() << std::endl;
+}
+
+void VoiceLLMService::bargeIn(int priority) {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    int64_t run = run_index_.load();
+    if (run < 0 || priority > running_priority_) return;
+
+    // 发送线程还没处理完该轮时丢弃剩余输出, 以 <flush> 代替 END
+    barge_in_index_.store(run);
+    if (in_flight_) {
+        // 后端在 run() 开头会清除取消标记, 由该轮下一次回调再 cancel() 一次兜底
+        stop_index_.store(run);
+        llm_->cancel();
+        std::cout << "[llm] barge-in: cancel answer " << run << std::endl;
+        return;
+    }
+
+    // 生成已结束 (含缓存重放): END 可能已发给 TTS 而音频还在播放, 由发送线程查询后清空
+    flush_playing_.store(true);
+    token_ring_.interrupt();
+    std::cout << "[llm] barge-in: answer " << run << " generated, check TTS playback" << std::endl;
+}
+
+void VoiceLLMService::inferenceLoop() {
     // 创建回调函数对象
-    std::function<void(RKLLMResult*, LLMCallState)> callback =
-        [this](RKLLMResult* result, LLMCallState state) { this->handleCallback(result, state); };
+    LLMBackend::Callback callback = [this](const char* text, LLMRunState state) {
+        this->handleCallback(text, state);
+    };
+
+    RagRequest request;
+    while (scheduler_.pop(request)) {
+        std::vector<ChatTurn> history;
+        if (!request.session_id.empty()) {
+            waitAnswersDone();
+            history = sessions_.history(request.session_id);
+        }
+
+        AnswerPlan plan;
+        plan.generation = request.generation;
+        plan.session_id = request.session_id;
+        plan.query      = request.query;
+        // 有历史时回答依赖上下文 ("那要多久?"), 不查也不写回答缓存
+        if (answer_cache_.enabled() && history.empty()) {
+            plan.cache_key = AnswerCache::makeKey(request);
+            if (!plan.cache_key.empty()) plan.replay = answer_cache_.lookup(plan.cache_key);
+        }
+        bool replay = plan.replay != nullptr;
+        if (replay) {
+            plan.cache_key.clear();  // 重放的回答不再写回缓存
+        } else {
+            // 固定前导和 RAG 片段分段传给后端, 前缀相同的请求可以复用 prefill 结果
+            if (!request.rag.empty())
+                llm_->setSystemPrompt(buildRagPromptParts(request.rag, request.chunk_id));
+            else
+                llm_->setSystemPrompt({});
+            llm_->setHistory(request.session_id, history);
+            if (!history.empty()) {
+                std::cout << "[llm] session " << request.session_id << ": " << history.size()
+                          << " turns, " << sessions_.sessionCount() << " sessions / "
+                          << sessions_.totalTokens() << " tokens" << std::endl;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(plans_mutex_);
+            pending_plans_.push_back(std::move(plan));
+        }
+        {
+            std::lock_guard<std::mutex> lock(run_mutex_);
+            run_index_.fetch_add(1);
+            running_priority_ = request.priority;
+            in_flight_        = true;
+        }
 
+        if (replay) {
+            // 命中缓存: 不经过后端, 用一个 FINISH 槽位驱动发送线程重放
+            std::cout << "[llm] answer cache hit " << answer_cache_.hits() << "/"
+                      << answer_cache_.hits() + answer_cache_.misses() << std::endl;
+            handleCallback(nullptr, LLMRunState::FINISH);
+        } else {
+            resetCallbackStats();
+            llm_->run(request.query, request.generation, callback);
+            printCallbackStats();
+        }
+        {
+            std::lock_guard<std::mutex> lock(run_mutex_);
+            in_flight_ = false;
+        }
+    }
+}
+
+void VoiceLLMService::runForever() {
     while (true) {
         std::string text = server_.receive();
         std::cout << "[voice -> llm] received: " << text << std::endl;
         server_.send("LLM OK");
 
-        auto [query, rag] = splitRagTag(text);
-
-        if (!rag.empty())
-            llm_.setChatTemplate(buildRagPrompt(rag));
-        else
-            llm_.setChatTemplate("");
-
-        llm_.run(query, &callback);
+        // 先打断再入队, 否则推理线程可能已经取走新请求, 打断的就是它自己
+        RagRequest request = parseRagRequest(text);
+        bargeIn(request.priority);
+        size_t dropped = scheduler_.submit(std::move(request));
+        if (dropped > 0) {
+            std::cout << "[llm] dropped " << dropped << " queued request(s)" << std::endl;
+        }
     }
 }
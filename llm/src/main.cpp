@@ -1,13 +1,65 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
 #include "VoiceLLMService.h"
 
+static void usage(const char* prog)
+{
+    printf("Usage: %s model_path [--backend rkllm|llama|mock] [--threads N] [--mock-tps N]\n"
+           "       [--answer-cache N] [--answer-cache-ttl SECONDS]\n"
+           "       [--session-tokens N] [--session-total-tokens N] [--session-idle SECONDS]\n",
+           prog);
+    printf("  compiled backends:");
+    for (const auto& name : availableLLMBackends()) printf(" %s", name.c_str());
+    printf("\n  mock: model_path is a script file (one answer per line), '-' for built-in answers\n");
+    printf("  answer cache: N entries (0 disables, default 64), TTL 0 never expires\n");
+    printf("  sessions: history budget per session (default 96) and in total (default 1024)\n");
+}
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
-        printf("Usage: %s model_path\n", argv[0]);
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string backend_type;
+    LLMBackendOptions options;
+    AnswerCacheConfig cache_config;
+    SessionConfig session_config;
+    for (int i = 2; i < argc; ++i) {
+        if (!strcmp(argv[i], "--backend") && i + 1 < argc) {
+            backend_type = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.cpu_threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--mock-tps") && i + 1 < argc) {
+            options.mock_tokens_per_second = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--answer-cache") && i + 1 < argc) {
+            cache_config.capacity = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--answer-cache-ttl") && i + 1 < argc) {
+            cache_config.ttl_seconds = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--session-tokens") && i + 1 < argc) {
+            session_config.max_history_tokens = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--session-total-tokens") && i + 1 < argc) {
+            session_config.max_total_tokens = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--session-idle") && i + 1 < argc) {
+            session_config.idle_timeout_seconds = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<LLMBackend> backend = createLLMBackend(backend_type, options);
+    if (!backend) {
+        std::cerr << "Unsupported backend: " << backend_type << std::endl;
+        usage(argv[0]);
         return 1;
     }
+    std::cout << "LLM backend: " << backend->name() << std::endl;
 
-    VoiceLLMService service(argv[1]);
+    VoiceLLMService service(argv[1], std::move(backend), cache_config, session_config);
     service.runForever();
 
     return 0;
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace text_segmenter {
+
+struct SegmenterConfig {
+    // 分句字符 (UTF-8 书写, 每个码点单独生效). 遇到时若当前分段已达 min_chars 则输出
+    std::string delimiters = "。！？；：，、\n!?;";
+    // 从输出中删除的字符, 用于清洗 markdown 符号和 TTS 不需要的标点
+    std::string strip_chars;
+    // 句末字符, 只用于 sentenceCount() 计数 (分段可能是半句, 句数按句末字符算)
+    std::string terminators = "。！？!?";
+    size_t min_chars    = 1;   // 短于该长度(码点数)的分段与后续内容合并
+    size_t max_chars    = 0;   // 达到该长度时在码点边界强制切分, 0 表示不限制
+    bool keep_delimiter = true;  // 为 false 时去掉分段末尾的分句字符
+};
+
+// 流式 UTF-8 分句器: 可按任意字节边界喂入数据, 码点跨调用时保留解码状态,
+// 只在完整码点边界切分, 非法字节直接丢弃, 输出保证是合法 UTF-8.
+// 字符分类查表完成 (ASCII 直接索引, 其余码点二分查找), 不做宽字符转换也不用正则. 非线程安全.
+class Utf8Segmenter {
+   public:
+    using Sink = std::function<void(const std::string&)>;
+
+    explicit Utf8Segmenter(const SegmenterConfig& config = SegmenterConfig());
+
+    // 追加数据, 每凑成一个分段调用一次 sink
+    void feed(const char* data, size_t length, const Sink& sink);
+    void feed(const std::string& text, const Sink& sink) { feed(text.data(), text.size(), sink); }
+
+    // 输出剩余内容并复位, 不完整的码点被丢弃
+    void finish(const Sink& sink);
+    void reset();
+
+    // 当前分段已累积的码点数
+    size_t pendingChars() const { return segment_chars_; }
+    // 自上次 reset()/finish() 以来完成的句子数: 句末字符之前有内容才计一句, 即使该字符被删除.
+    // 在 sink 回调中读取时已包含触发本次输出的句末字符
+    size_t sentenceCount() const { return sentence_count_; }
+
+    // 一次性切分完整文本
+    static std::vector<std::string> split(const std::string& text,
+                                          const SegmenterConfig& config = SegmenterConfig());
+
+   private:
+    enum : uint8_t { kBreak = 1, kStrip = 2, kSpace = 4, kTerminal = 8 };
+
+    void addClass(const std::string& utf8, uint8_t cls);
+    uint8_t classify(uint32_t cp) const;
+    void onCodePoint(uint32_t cp, const char* bytes, size_t length, const Sink& sink);
+    void emit(const Sink& sink);
+
+    SegmenterConfig config_;
+    uint8_t ascii_class_[128] = {};
+    std::vector<std::pair<uint32_t, uint8_t>> extra_class_;  // 按码点排序
+
+    // 解码状态: 当前码点已收到的字节和还需要的后续字节数
+    char char_bytes_[4] = {};
+    size_t char_length_ = 0;
+    size_t char_need_   = 0;
+    uint32_t char_cp_   = 0;
+
+    std::string segment_;
+    size_t segment_chars_  = 0;
+    size_t trailing_delim_ = 0;  // segment_ 末尾分句字符的字节数
+    size_t sentence_count_ = 0;
+    bool sentence_open_    = false;  // 上一个句末字符之后是否出现过内容
+};
+
+// 手册原文直接播报的分句配置: 分隔符本身不发送, 开头过短的句子与后文合并.
+// RAG 播报和 TTS 离线预合成共用, 两边切出的句子一致才能按句序号对应
+SegmenterConfig manual_speech_config();
+
+// 手册片段中实际播报的正文: 去掉开头的 "章节: X | 子章节: Y |" 元数据 (第二个 '|' 及之前)
+// 和随后的空白, 没有该头部时原样返回. RAG 播报和 TTS 离线预合成都先经过这里再分句
+std::string manual_speech_text(const std::string& chunk);
+
+// 按 UTF-8 码点计数, 不校验合法性
+size_t utf8_length(const std::string& text);
+
+// 返回 data 中由完整码点组成的最长前缀的字节数
+size_t utf8_complete_prefix(const char* data, size_t length);
+
+}  // namespace text_segmenter
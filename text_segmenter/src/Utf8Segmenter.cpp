@@ -0,0 +1,210 @@
+#include "Utf8Segmenter.h"
+
+#include <algorithm>
+
+namespace text_segmenter {
+
+namespace {
+
+// 解码一段完整的 UTF-8 文本, 用于解析配置中的字符集合. 非法字节跳过
+template <typename Fn>
+void for_each_code_point(const std::string& utf8, Fn fn) {
+    size_t i = 0;
+    while (i < utf8.size()) {
+        unsigned char c = static_cast<unsigned char>(utf8[i]);
+        size_t len      = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3
+                                     : (c & 0xF8) == 0xF0   ? 4
+                                                            : 0;
+        if (len == 0 || i + len > utf8.size()) {
+            ++i;
+            continue;
+        }
+        uint32_t cp = len == 1 ? c : c & (0x7F >> len);
+        for (size_t j = 1; j < len; ++j) {
+            cp = (cp << 6) | (static_cast<unsigned char>(utf8[i + j]) & 0x3F);
+        }
+        fn(cp);
+        i += len;
+    }
+}
+
+}  // namespace
+
+Utf8Segmenter::Utf8Segmenter(const SegmenterConfig& config) : config_(config) {
+    addClass(" \t\r\n\xE3\x80\x80", kSpace);  // 含全角空格 U+3000
+    addClass(config_.delimiters, kBreak);
+    addClass(config_.strip_chars, kStrip);
+    addClass(config_.terminators, kTerminal);
+}
+
+void Utf8Segmenter::addClass(const std::string& utf8, uint8_t cls) {
+    for_each_code_point(utf8, [this, cls](uint32_t cp) {
+        if (cp < 128) {
+            ascii_class_[cp] |= cls;
+            return;
+        }
+        auto it = std::lower_bound(
+            extra_class_.begin(), extra_class_.end(), cp,
+            [](const std::pair<uint32_t, uint8_t>& entry, uint32_t key) { return entry.first < key; });
+        if (it != extra_class_.end() && it->first == cp) {
+            it->second |= cls;
+        } else {
+            extra_class_.insert(it, {cp, cls});
+        }
+    });
+}
+
+uint8_t Utf8Segmenter::classify(uint32_t cp) const {
+    if (cp < 128) return ascii_class_[cp];
+    auto it = std::lower_bound(
+        extra_class_.begin(), extra_class_.end(), cp,
+        [](const std::pair<uint32_t, uint8_t>& entry, uint32_t key) { return entry.first < key; });
+    return (it != extra_class_.end() && it->first == cp) ? it->second : 0;
+}
+
+void Utf8Segmenter::feed(const char* data, size_t length, const Sink& sink) {
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+
+        if (char_need_ > 0) {
+            if ((c & 0xC0) == 0x80) {
+                char_bytes_[char_length_++] = static_cast<char>(c);
+                char_cp_                    = (char_cp_ << 6) | (c & 0x3F);
+                if (--char_need_ == 0) {
+                    onCodePoint(char_cp_, char_bytes_, char_length_, sink);
+                }
+                continue;
+            }
+            // 多字节序列被截断, 丢弃已收到的部分, 当前字节重新作为首字节处理
+            char_need_ = 0;
+        }
+
+        if (c < 0x80) {
+            char bytes = static_cast<char>(c);
+            onCodePoint(c, &bytes, 1, sink);
+            continue;
+        }
+
+        size_t len = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+        if (len == 0) continue;  // 孤立的后续字节或非法首字节
+
+        char_bytes_[0] = static_cast<char>(c);
+        char_length_   = 1;
+        char_need_     = len - 1;
+        char_cp_       = c & (0x7F >> len);
+    }
+}
+
+void Utf8Segmenter::onCodePoint(uint32_t cp, const char* bytes, size_t length, const Sink& sink) {
+    uint8_t cls = classify(cp);
+
+    if (cls & kTerminal) {
+        if (sentence_open_) ++sentence_count_;
+        sentence_open_ = false;
+    } else if (!(cls & (kSpace | kBreak | kStrip))) {
+        sentence_open_ = true;
+    }
+
+    if (!(cls & kStrip) && !((cls & kSpace) && segment_.empty())) {
+        segment_.append(bytes, length);
+        ++segment_chars_;
+        trailing_delim_ = (cls & kBreak) ? length : 0;
+    }
+
+    if ((cls & kBreak) && segment_chars_ >= config_.min_chars) {
+        emit(sink);
+    } else if (config_.max_chars > 0 && segment_chars_ >= config_.max_chars) {
+        emit(sink);
+    }
+}
+
+void Utf8Segmenter::emit(const Sink& sink) {
+    if (!config_.keep_delimiter && trailing_delim_ > 0) {
+        segment_.resize(segment_.size() - trailing_delim_);
+    }
+    // 去掉尾部空白, 包括全角空格
+    while (!segment_.empty()) {
+        size_t n = segment_.size();
+        if (segment_[n - 1] == ' ' || segment_[n - 1] == '\t' || segment_[n - 1] == '\r' ||
+            segment_[n - 1] == '\n') {
+            segment_.resize(n - 1);
+        } else if (n >= 3 && segment_.compare(n - 3, 3, "\xE3\x80\x80") == 0) {
+            segment_.resize(n - 3);
+        } else {
+            break;
+        }
+    }
+
+    if (!segment_.empty()) sink(segment_);
+
+    segment_.clear();
+    segment_chars_  = 0;
+    trailing_delim_ = 0;
+}
+
+void Utf8Segmenter::finish(const Sink& sink) {
+    char_need_ = 0;
+    emit(sink);
+    sentence_count_ = 0;
+    sentence_open_  = false;
+}
+
+void Utf8Segmenter::reset() {
+    char_need_      = 0;
+    sentence_count_ = 0;
+    sentence_open_  = false;
+    segment_.clear();
+    segment_chars_  = 0;
+    trailing_delim_ = 0;
+}
+
+std::vector<std::string> Utf8Segmenter::split(const std::string& text,
+                                              const SegmenterConfig& config) {
+    std::vector<std::string> segments;
+    Utf8Segmenter segmenter(config);
+    auto sink = [&segments](const std::string& segment) { segments.push_back(segment); };
+    segmenter.feed(text, sink);
+    segmenter.finish(sink);
+    return segments;
+}
+
+SegmenterConfig manual_speech_config() {
+    SegmenterConfig config;
+    config.delimiters     = "。！？；：\n?!，、|";
+    config.min_chars      = 6;
+    config.keep_delimiter = false;
+    return config;
+}
+
+std::string manual_speech_text(const std::string& chunk) {
+    size_t first  = chunk.find('|');
+    size_t second = first == std::string::npos ? first : chunk.find('|', first + 1);
+    if (second == std::string::npos) return chunk;
+
+    size_t start = chunk.find_first_not_of(" \t\r\n", second + 1);
+    return start == std::string::npos ? std::string() : chunk.substr(start);
+}
+
+size_t utf8_length(const std::string& text) {
+    size_t count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++count;
+    }
+    return count;
+}
+
+size_t utf8_complete_prefix(const char* data, size_t length) {
+    size_t i = length;
+    // 最多回看 3 个字节寻找最后一个码点的首字节
+    while (i > 0 && length - i < 4) {
+        unsigned char c = static_cast<unsigned char>(data[i - 1]);
+        if ((c & 0xC0) != 0x80) {
+            size_t need = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+            return (length - (i - 1) >= need) ? length : i - 1;
+        }
+        --i;
+    }
+    return length;
+}
+
+}  // namespace text_segmenter
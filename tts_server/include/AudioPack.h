@@ -0,0 +1,63 @@
+#ifndef AUDIO_PACK_H
+#define AUDIO_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PcmClip.h"
+
+// 离线预合成的手册音频包, 按 (片段 ID, 句序号) 索引.
+// RAG 直接播报手册原文时只发 "<play chunk=ID hash=H>", TTS 从音频包取音频, 不再现场合成.
+// H 为片段原文的哈希, 手册重建索引而音频包未重建时哈希不一致, 按未命中处理
+class AudioPack {
+public:
+    // 只读映射, 失败返回 nullptr
+    static std::shared_ptr<AudioPack> open(const std::string &path);
+
+    // 按句序号返回该片段的全部句子; 片段不存在、哈希不一致或缺句时返回空
+    std::vector<PcmClip> chunk(uint32_t chunk_id, uint32_t text_hash) const;
+
+    uint32_t sample_rate() const { return sample_rate_; }
+    size_t sentence_count() const { return entry_count_; }
+
+    // 片段原文的 FNV-1a 哈希, RAG 侧按同样算法计算
+    static uint32_t text_hash(const std::string &text);
+    static std::string play_command(uint32_t chunk_id, uint32_t text_hash);
+    // 不是播放命令时返回 false
+    static bool parse_play(const std::string &command, uint32_t &chunk_id, uint32_t &text_hash);
+
+private:
+    AudioPack() = default;
+
+    std::shared_ptr<const void> mapping_;
+    const char *base_ = nullptr;
+    size_t size_ = 0;
+    size_t entry_count_ = 0;
+    uint32_t sample_rate_ = 0;
+};
+
+// 生成音频包 (离线工具 tts_pack 使用), 句子可以按任意顺序加入
+class AudioPackWriter {
+public:
+    void add(uint32_t chunk_id, uint32_t sentence, uint32_t sentence_count, uint32_t text_hash,
+             const int16_t *samples, size_t length);
+    bool write(const std::string &path, uint32_t sample_rate) const;
+
+    size_t sentence_count() const { return sentences_.size(); }
+
+private:
+    struct Sentence {
+        uint32_t chunk_id;
+        uint32_t index;
+        uint32_t count;
+        uint32_t text_hash;
+        std::vector<int16_t> samples;
+    };
+
+    std::vector<Sentence> sentences_;
+};
+
+#endif  // AUDIO_PACK_H
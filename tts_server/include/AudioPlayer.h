@@ -1,22 +1,57 @@
 #ifndef AUDIO_PLAYER_H
 #define AUDIO_PLAYER_H
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 #include <alsa/asoundlib.h>
 
-class AudioPlayer {
+#include "AudioSink.h"
+
+// 流式播放: 设备只在 initialize() 中配置一次, 之后按周期大小连续写入.
+// 一段回答内句与句之间不 drain, 下一句还没合成好时用 keep_alive() 补静音保持设备运行,
+// 只有回答结束才 drain. 所有接口只能在播放线程调用
+class AudioPlayer : public AudioSink {
 public:
-    AudioPlayer();
-    ~AudioPlayer();
-    
+    // latency_us: ALSA 缓冲总时长, 决定写入到出声的最大延迟
+    explicit AudioPlayer(unsigned int sample_rate = 16000, unsigned int latency_us = 50000);
+    ~AudioPlayer() override;
+
     bool initialize();
-    void play(const int16_t* audioData, int audio_len, float speed = 1.0f);
-    
+    bool is_open() const { return initialized_; }
+
+    // 按周期大小分块写入单声道 S16 样本, 设备缓冲满时阻塞; 欠载后恢复设备并继续写
+    void write(const int16_t* samples, size_t frames) override;
+    // 句间等待新音频时周期性调用: 设备中剩余不足两个周期就补一个周期的静音
+    void keep_alive() override;
+    // 回答结束: 等设备播完已写入的音频, 然后准备好下一段回答
+    void drain() override;
+    // 回答被打断: 丢弃设备缓冲中尚未播放的音频
+    void drop() override;
+
+    unsigned int sample_rate() const override { return sample_rate_; }
+    size_t period_frames() const override { return period_size_; }
+
+    uint64_t underruns() const { return underruns_; }
+    void print_stats() const override;
+
 private:
+    bool recover(int err);
+    snd_pcm_sframes_t queued_frames();
     void cleanup();
-    
+
     snd_pcm_t* pcm_handle_ = nullptr;
     bool initialized_ = false;
+
+    unsigned int sample_rate_;
+    unsigned int latency_us_;
+    snd_pcm_uframes_t buffer_size_ = 0;
+    snd_pcm_uframes_t period_size_ = 0;
+    std::vector<int16_t> silence_;  // 一个周期的静音
+
+    uint64_t underruns_ = 0;
+    uint64_t silence_frames_ = 0;
 };
 
-#endif // AUDIO_PLAYER_H
\ No newline at end of file
+#endif // AUDIO_PLAYER_H
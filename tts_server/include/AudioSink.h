@@ -0,0 +1,87 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// 播放线程的输出端. 一段回答内连续 write(), 等下一句时周期性 keep_alive(),
+// 回答结束 drain(), 被打断 drop(). 所有接口只在播放线程调用
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    // 单声道 S16 样本, 按需阻塞 (设备缓冲满或按实时速度限速)
+    virtual void write(const int16_t* samples, size_t frames) = 0;
+    virtual void keep_alive() {}
+    virtual void drain() {}
+    virtual void drop() {}
+
+    virtual unsigned int sample_rate() const = 0;
+    // 每次写入、检查打断和补静音的粒度
+    virtual size_t period_frames() const = 0;
+    std::chrono::microseconds period_time() const
+    {
+        return std::chrono::microseconds(1000000ULL * period_frames() / sample_rate());
+    }
+
+    virtual void print_stats() const {}
+
+    // spec: "alsa" 默认声卡; "null" 丢弃但按实时速度播放; "null-fast" 丢弃且不限速;
+    // "wav:路径" 写入 WAV 文件, 不限速. 不认识的 spec 或设备、文件打不开时返回 nullptr
+    static std::unique_ptr<AudioSink> create(const std::string& spec, unsigned int sample_rate);
+};
+
+// 无声卡环境 (CI、构建服务器) 下测吞吐和延迟: 丢弃音频, 用虚拟播放时钟模拟设备.
+// 实时模式下写入时虚拟时钟已落后于当前时间说明真实设备会欠载, 计入 underruns
+class NullSink : public AudioSink {
+public:
+    NullSink(unsigned int sample_rate, bool realtime);
+
+    void write(const int16_t* samples, size_t frames) override;
+    void drain() override;
+    void drop() override;
+
+    unsigned int sample_rate() const override { return sample_rate_; }
+    size_t period_frames() const override { return sample_rate_ / 100; }
+    void print_stats() const override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    unsigned int sample_rate_;
+    bool realtime_;
+    bool playing_ = false;
+    Clock::time_point play_until_;  // 已写入的音频在虚拟设备上播完的时刻
+    uint64_t frames_ = 0;
+    uint64_t underruns_ = 0;
+};
+
+// 写入 WAV 文件, 每段回答结束时回填文件头, 进程被杀也能得到完整的前几段
+class WavSink : public AudioSink {
+public:
+    WavSink(const std::string& path, unsigned int sample_rate);
+    ~WavSink() override;
+
+    bool is_open() const { return fp_ != nullptr; }
+
+    void write(const int16_t* samples, size_t frames) override;
+    void drain() override;
+
+    unsigned int sample_rate() const override { return sample_rate_; }
+    size_t period_frames() const override { return sample_rate_ / 100; }
+    void print_stats() const override;
+
+private:
+    void update_header();
+
+    std::string path_;
+    unsigned int sample_rate_;
+    FILE* fp_ = nullptr;
+    uint64_t frames_ = 0;
+};
+
+#endif  // AUDIO_SINK_H
@@ -2,39 +2,76 @@
 #define MESSAGE_QUEUE_H
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <cstdint>
 #include <memory>
-#include <mutex>
-#include <queue>
 #include <string>
 
+#include "PcmClip.h"
+#include "SpscRing.h"
+
+struct TextMessage {
+    std::string text;
+    uint64_t epoch = 0;
+};
+
 struct AudioMessage {
-    std::unique_ptr<int16_t[]> data;
-    size_t length;
+    PcmClip audio;
     bool is_last = false;
+    uint64_t epoch = 0;
+    uint32_t pause_ms = 0;  // 播放完该段、下一段之前补的静音
 };
 
+// 事件循环线程 -> 合成线程 -> 播放线程 两段交接, 各用一个无锁 SPSC 队列.
+// clear() 只增加代数, 两个消费者各自跳过旧代的数据, 不需要跨线程改动队列
 class DoubleMessageQueue {
    public:
-    void push_text(const std::string &msg);
-    std::string pop_text();
+    enum class StopMode {
+        kDrain,  // 合成完已收到的文本、播放完已合成的音频后退出
+        kAbort,  // 立即退出, 丢弃剩余数据
+    };
 
-    void push_audio(std::unique_ptr<int16_t[]> data, size_t length, bool is_last = false);
-    AudioMessage pop_audio();
+    explicit DoubleMessageQueue(size_t text_capacity = 64, size_t audio_capacity = 16);
 
-    void stop();
+    // 事件循环线程. 队列满时返回 false, 不阻塞事件循环, 由调用方稍后重试 (不丢弃文本)
+    bool push_text(const std::string &msg);
+    // 合成线程. 停止后返回 false; epoch 原样交给 push_audio
+    bool pop_text(std::string &text, uint64_t &epoch);
 
-   private:
-    std::queue<std::string> text_queue_;
-    std::mutex text_mutex_;
-    std::condition_variable text_cond_;
+    // 合成线程. 队列满时等待播放线程; 取文本后队列被 clear() 过时丢弃该段音频, 返回 false
+    bool push_audio(PcmClip audio, bool is_last, uint64_t epoch, uint32_t pause_ms = 0);
+    // 合成线程退出前调用, 播放线程放完剩余音频后 pop_audio 返回 false
+    void close_audio();
+    // 播放线程. 跳过 clear() 之前合成的音频, 停止后返回 false
+    bool pop_audio(AudioMessage &msg);
+    // 播放线程, 最多等待 timeout, 期间没有新音频时播放线程可以补静音
+    RingPop pop_audio_for(AudioMessage &msg, std::chrono::microseconds timeout);
+
+    // 丢弃所有未合成的文本和未播放的音频 (LLM 回答被打断)
+    void clear();
+    // 当前代数, 与 AudioMessage::epoch 不同说明该段所属回答已被打断
+    uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
 
-    std::queue<AudioMessage> audio_queue_;
-    std::mutex audio_mutex_;
-    std::condition_variable audio_cond_;
+    // 已收到结束 (END 或播放命令) 但还没播放完的回答数, clear() 后归零.
+    // 生成早已结束、仍在播放的回答被打断时, LLM 据此判断是否需要 <flush>
+    void answer_received() { open_answers_.fetch_add(1, std::memory_order_acq_rel); }
+    void answer_played();
+    bool answer_pending() const { return open_answers_.load(std::memory_order_acquire) > 0; }
+
+    void stop(StopMode mode = StopMode::kDrain);
+
+    RingStats text_stats() const { return text_ring_.stats(); }
+    RingStats audio_stats() const { return audio_ring_.stats(); }
+    uint64_t dropped() const { return dropped_; }
+    void print_stats() const;
+
+   private:
+    SpscRing<TextMessage> text_ring_;
+    SpscRing<AudioMessage> audio_ring_;
 
-    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint64_t> open_answers_{0};
+    std::atomic<uint64_t> dropped_{0};  // 被 clear() 丢弃的条目数
 };
 
-#endif  // MESSAGE_QUEUE_H
\ No newline at end of file
+#endif  // MESSAGE_QUEUE_H
@@ -0,0 +1,35 @@
+#ifndef MODEL_WEIGHTS_H
+#define MODEL_WEIGHTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// TTS 模型权重. 模型文件本身就是连续的 float 数组, 直接 mmap 而不是读进堆内存:
+// 同一进程内多个 SynthesizerTrn 共享一份, 多个进程也共享同一份页缓存, 页面按需载入.
+// 映射为私有写时复制, 权重只读时所有实例共用物理页
+class ModelWeights {
+public:
+    // 映射失败时退回 ttsLoadModel 整体读入; 仍失败返回 nullptr
+    static std::shared_ptr<ModelWeights> load(const std::string &model_path);
+    ~ModelWeights();
+
+    ModelWeights(const ModelWeights &) = delete;
+    ModelWeights &operator=(const ModelWeights &) = delete;
+
+    // SynthesizerTrn 的接口是 float*, 不会改写权重
+    float *data() const { return data_; }
+    int32_t size() const { return size_; }
+    bool mapped() const { return mapped_; }
+
+private:
+    ModelWeights() = default;
+
+    float *data_ = nullptr;
+    int32_t size_ = 0;      // 字节数, 与 ttsLoadModel 的返回值一致
+    size_t map_length_ = 0;
+    bool mapped_ = false;
+};
+
+#endif  // MODEL_WEIGHTS_H
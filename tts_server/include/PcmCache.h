@@ -0,0 +1,64 @@
+#ifndef PCM_CACHE_H
+#define PCM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "PcmClip.h"
+
+struct PcmCacheConfig {
+    size_t max_bytes = 32u << 20;  // 内存层预算, 0 表示关闭缓存
+    std::string disk_dir;           // 磁盘层目录, 空表示不落盘
+};
+
+// 合成结果缓存, key 由规范化文本、音色和语速组成.
+// 内存层按字节预算 LRU 淘汰, 与播放队列共享同一份音频;
+// 磁盘层每条一个文件, 文件名为 key 的哈希, 命中时只读映射, 进程重启后仍可命中.
+// 分发线程查询、合成线程写入, 内部加锁
+class PcmCache {
+public:
+    explicit PcmCache(PcmCacheConfig config = PcmCacheConfig());
+
+    bool enabled() const { return config_.max_bytes > 0; }
+
+    // 去掉空白; 标点影响停顿, 保留
+    static std::string make_key(const std::string &text, int32_t speaker_id, float speed);
+
+    // 先查内存层, 再查磁盘层 (命中后放入内存层)
+    bool lookup(const std::string &key, PcmClip &clip);
+    // infer_ms 为合成这段音频花的时间, 命中时计入节省的推理时间
+    void insert(const std::string &key, const PcmClip &clip, uint32_t infer_ms);
+
+    void print_stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        PcmClip clip;
+        uint32_t infer_ms = 0;
+        size_t bytes = 0;
+    };
+
+    void insert_locked(const std::string &key, const PcmClip &clip, uint32_t infer_ms);
+    bool load_from_disk(const std::string &key, PcmClip &clip, uint32_t &infer_ms) const;
+    void save_to_disk(const std::string &key, const PcmClip &clip, uint32_t infer_ms) const;
+    std::string disk_path(const std::string &key) const;
+
+    PcmCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;  // 最近使用的在前
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t bytes_ = 0;
+
+    uint64_t memory_hits_ = 0;
+    uint64_t disk_hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t saved_ms_ = 0;
+};
+
+#endif  // PCM_CACHE_H
@@ -0,0 +1,22 @@
+#ifndef PCM_CLIP_H
+#define PCM_CLIP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 一段单声道 S16 音频. 样本只读, 由最后一个引用按来源释放 (合成器输出交还 tts_free_data,
+// 音频包和磁盘缓存解除映射), 从合成线程经重排缓冲区、缓存、播放队列到播放器全程不复制
+struct PcmClip {
+    std::shared_ptr<const int16_t> samples;
+    size_t length = 0;
+    // samples 所引用的整块缓冲区的字节数. 裁剪后的 PcmClip 只指向其中一段, 但仍持有整块;
+    // 0 表示缓冲区正好是这 length 个样本
+    size_t buffer_bytes = 0;
+
+    bool empty() const { return length == 0; }
+    // 持有这段音频实际占用的内存, 缓存按此计入预算
+    size_t memory_bytes() const { return buffer_bytes ? buffer_bytes : length * sizeof(int16_t); }
+};
+
+#endif  // PCM_CLIP_H
@@ -0,0 +1,39 @@
+#ifndef SILENCE_TRIMMER_H
+#define SILENCE_TRIMMER_H
+
+#include <cstdint>
+#include <string>
+
+#include "PcmClip.h"
+
+struct SilenceTrimConfig {
+    bool enabled = true;
+    float threshold_db = -35.0f;       // 相对最响的 10ms 帧, 低于该能量的首尾帧视为静音
+    uint32_t lead_ms = 20;             // 起音前保留的余量
+    uint32_t tail_ms = 50;             // 尾音后保留的余量, 不截断衰减
+    uint32_t sentence_pause_ms = 200;  // 句与句之间插入的停顿
+    uint32_t phrase_pause_ms = 100;    // 句内逗号等标点处切块时插入的停顿
+};
+
+// 合成结果首尾都带有模型生成的静音, 逐句合成时累加成首字前和句间可感知的延迟.
+// 按能量去掉首尾静音, 句间停顿改由播放线程按 pause_after() 补静音, 长度可配置
+class SilenceTrimmer {
+public:
+    SilenceTrimmer(SilenceTrimConfig config, unsigned int sample_rate);
+
+    // 返回指向原缓冲区中有声部分的 PcmClip (别名 shared_ptr, 不复制, 原缓冲区随之保留).
+    // 全静音或关闭时原样返回
+    PcmClip trim(const PcmClip &clip) const;
+
+    // chunk 之后应插入的停顿. end_of_sentence: 该块是收到的一句的最后一块;
+    // 句内块以标点结尾时按标点停顿, 无标点 (过长被硬切) 时不停顿
+    uint32_t pause_after(const std::string &chunk, bool end_of_sentence) const;
+
+    const SilenceTrimConfig &config() const { return config_; }
+
+private:
+    SilenceTrimConfig config_;
+    unsigned int sample_rate_;
+};
+
+#endif  // SILENCE_TRIMMER_H
@@ -0,0 +1,227 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct RingStats {
+    size_t depth = 0;
+    size_t max_depth = 0;
+    uint64_t pushes = 0;
+    uint64_t pop_waits = 0;       // 消费者遇到空队列的次数
+    uint64_t pop_wait_ns = 0;     // 消费者累计等待时间
+    uint64_t pop_wait_max_ns = 0;
+    uint64_t push_waits = 0;      // 生产者遇到满队列的次数
+    uint64_t push_wait_ns = 0;
+};
+
+enum class RingPop {
+    kOk,
+    kTimeout,
+    kStopped,  // close() 后已取完, 或 abort()
+};
+
+// 有界单生产者/单消费者无锁队列. 正常路径只有两个原子游标, 不加锁;
+// 一端需要等待时先让出 CPU 自旋, 仍未就绪才挂起, 只有对端确实挂起时才加锁唤醒.
+// close(): 生产者不再写入, 消费者取完剩余数据后 pop() 返回 false (drain);
+// abort(): 两端立即返回 false, 剩余数据丢弃
+template <typename T>
+class SpscRing {
+   public:
+    // capacity 向上取整为 2 的幂
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // 生产者侧, 队列满时返回 false, item 保持不变
+    bool try_push(T &item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t depth = tail - head_.load(std::memory_order_acquire);
+        if (depth > mask_) return false;
+
+        slots_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+
+        pushes_.store(pushes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (depth + 1 > max_depth_.load(std::memory_order_relaxed))
+            max_depth_.store(depth + 1, std::memory_order_relaxed);
+        wake(consumer_parked_);
+        return true;
+    }
+
+    // 生产者侧, 队列满时等待消费者. abort() 后返回 false
+    bool push(T &&item) {
+        if (aborted_.load(std::memory_order_acquire)) return false;
+        if (try_push(item)) return true;
+
+        auto start = std::chrono::steady_clock::now();
+        bool pushed = false;
+        wait_for_peer([&] {
+            if (aborted_.load(std::memory_order_acquire)) return true;
+            pushed = try_push(item);
+            return pushed;
+        }, producer_parked_);
+
+        push_waits_.fetch_add(1, std::memory_order_relaxed);
+        push_wait_ns_.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        return pushed;
+    }
+
+    // 消费者侧, 无数据时返回 false
+    bool try_pop(T &item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+
+        item = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        wake(producer_parked_);
+        return true;
+    }
+
+    // 消费者侧, 阻塞直到取到数据. close() 后取完或 abort() 后返回 false
+    bool pop(T &item) { return pop_until(item, nullptr) == RingPop::kOk; }
+
+    // 消费者侧, 最多等待 timeout
+    RingPop pop_for(T &item, std::chrono::microseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return pop_until(item, &deadline);
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        wake(consumer_parked_);
+    }
+
+    void abort() {
+        aborted_.store(true, std::memory_order_release);
+        wake(consumer_parked_);
+        wake(producer_parked_);
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    RingStats stats() const {
+        RingStats s;
+        s.depth = size();
+        s.max_depth = max_depth_.load(std::memory_order_relaxed);
+        s.pushes = pushes_.load(std::memory_order_relaxed);
+        s.pop_waits = pop_waits_.load(std::memory_order_relaxed);
+        s.pop_wait_ns = pop_wait_ns_.load(std::memory_order_relaxed);
+        s.pop_wait_max_ns = pop_wait_max_ns_.load(std::memory_order_relaxed);
+        s.push_waits = push_waits_.load(std::memory_order_relaxed);
+        s.push_wait_ns = push_wait_ns_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+   private:
+    static constexpr int kSpinRounds = 64;
+
+    static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    RingPop pop_until(T &item, const std::chrono::steady_clock::time_point *deadline) {
+        if (try_pop(item)) return RingPop::kOk;
+
+        auto start = std::chrono::steady_clock::now();
+        bool popped = false;
+        bool ready = wait_for_peer([&] {
+            if (aborted_.load(std::memory_order_acquire)) return true;
+            popped = try_pop(item);
+            return popped || closed_.load(std::memory_order_acquire);
+        }, consumer_parked_, deadline);
+        // close() 之前写入的最后一项可能在检查 closed_ 之后才可见
+        if (ready && !popped && !aborted_.load(std::memory_order_acquire)) popped = try_pop(item);
+
+        uint64_t ns = elapsed_ns(start);
+        pop_waits_.fetch_add(1, std::memory_order_relaxed);
+        pop_wait_ns_.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > pop_wait_max_ns_.load(std::memory_order_relaxed))
+            pop_wait_max_ns_.store(ns, std::memory_order_relaxed);
+
+        if (popped) return RingPop::kOk;
+        return ready ? RingPop::kStopped : RingPop::kTimeout;
+    }
+
+    // ready() 在本线程反复调用, 返回 true 时结束等待; 到 deadline 仍未就绪返回 false.
+    // 挂起的超时只是兜底, 正常情况下由对端唤醒
+    template <typename Ready>
+    bool wait_for_peer(Ready ready, std::atomic<bool> &parked,
+                       const std::chrono::steady_clock::time_point *deadline = nullptr) {
+        for (int i = 0; i < kSpinRounds; ++i) {
+            if (ready()) return true;
+            std::this_thread::yield();
+        }
+
+        bool result = false;
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        while (true) {
+            parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready()) {
+                result = true;
+                break;
+            }
+            auto wake_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+            if (deadline) {
+                if (std::chrono::steady_clock::now() >= *deadline) break;
+                if (*deadline < wake_at) wake_at = *deadline;
+            }
+            park_cond_.wait_until(lock, wake_at);
+        }
+        parked.store(false, std::memory_order_relaxed);
+        return result;
+    }
+
+    void wake(std::atomic<bool> &parked) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) &&
+            parked.exchange(false, std::memory_order_acq_rel)) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cond_.notify_all();
+        }
+    }
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> tail_{0};  // 生产者写
+    std::atomic<uint64_t> pushes_{0};
+    std::atomic<size_t> max_depth_{0};
+    std::atomic<uint64_t> push_waits_{0};
+    std::atomic<uint64_t> push_wait_ns_{0};
+
+    alignas(64) std::atomic<size_t> head_{0};  // 消费者写
+    std::atomic<uint64_t> pop_waits_{0};
+    std::atomic<uint64_t> pop_wait_ns_{0};
+    std::atomic<uint64_t> pop_wait_max_ns_{0};
+
+    alignas(64) std::atomic<bool> consumer_parked_{false};
+    std::atomic<bool> producer_parked_{false};
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> aborted_{false};
+
+    std::mutex park_mutex_;
+    std::condition_variable park_cond_;
+};
+
+#endif  // SPSC_RING_H
@@ -0,0 +1,102 @@
+#ifndef SYNTHESIS_POOL_H
+#define SYNTHESIS_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PcmCache.h"
+#include "SilenceTrimmer.h"
+#include "TTSModel.h"
+
+struct SynthesisConfig {
+    int workers = 2;        // 合成线程数, 每个线程一个 TTSModel (共享权重)
+    int omp_threads = 0;    // 每个合成线程内 OpenMP 线程数, 0 表示按核数平分
+    size_t max_ahead = 8;   // 已提交但还没交给播放线程的句子上限, 超出时 submit 等待
+    PcmCacheConfig cache;
+    SilenceTrimConfig trim;
+};
+
+struct SynthesisResult {
+    uint64_t seq = 0;
+    PcmClip audio;
+    bool is_last = false;
+    uint64_t epoch = 0;
+    uint32_t infer_ms = 0;  // 实际推理耗时, 缓存命中和 submit_audio() 为 0
+    uint32_t pause_ms = 0;  // 播放完该段后插入的停顿
+};
+
+// 多个合成线程并行推理, 去掉首尾静音后放入重排缓冲区, 按提交顺序交付.
+// 缓存命中的句子和 submit_audio() 的音频直接放入重排缓冲区, 不经过合成线程.
+// 一个分发线程调用 submit(), 一个交付线程调用 next().
+// 合成线程共享同一份模型权重, 各自持有推理实例
+class SynthesisPool {
+public:
+    // stale(epoch) 为 true 的任务已被打断, 不再合成, 只交付空结果保持顺序
+    SynthesisPool(const std::string &model_path, SynthesisConfig config,
+                  std::function<bool(uint64_t)> stale);
+    ~SynthesisPool();
+
+    SynthesisPool(const SynthesisPool &) = delete;
+    SynthesisPool &operator=(const SynthesisPool &) = delete;
+
+    // 按调用顺序编号. close() 后返回 false
+    bool submit(std::string text, bool is_last, uint64_t epoch, uint32_t pause_ms = 0);
+    // 已有的音频 (音频包) 不经过合成线程, 与文本一起按提交顺序交付, 不复制样本.
+    // 音频包由 tts_pack 经合成线程生成, 已去掉首尾静音, 这里不再裁剪
+    bool submit_audio(const PcmClip &clip, bool is_last, uint64_t epoch, uint32_t pause_ms = 0);
+    // 阻塞到下一个编号的结果合成完. close() 且全部交付后返回 false
+    bool next(SynthesisResult &result);
+    // 不再接受新任务, 已提交的任务照常合成和交付
+    void close();
+
+    int workers() const { return static_cast<int>(models_.size()); }
+    const SilenceTrimmer &trimmer() const { return trimmer_; }
+    // 累计实时率 (推理耗时 / 音频时长) 和缓存统计
+    void print_stats() const;
+
+private:
+    struct Job {
+        uint64_t seq = 0;
+        std::string text;
+        bool is_last = false;
+        uint64_t epoch = 0;
+        uint32_t pause_ms = 0;
+    };
+
+    void worker_loop(int index);
+    // 等到提前量窗口有空位, 已关闭返回 false
+    bool wait_for_space(std::unique_lock<std::mutex> &lock);
+    static std::string cache_key(const std::string &text);
+
+    SynthesisConfig config_;
+    std::function<bool(uint64_t)> stale_;
+    std::vector<std::unique_ptr<TTSModel>> models_;
+    std::vector<std::thread> threads_;
+    PcmCache cache_;
+    SilenceTrimmer trimmer_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable job_cond_;    // 新任务或关闭
+    std::condition_variable done_cond_;   // 新结果或关闭
+    std::condition_variable space_cond_;  // 交付后窗口腾出空位
+    std::deque<Job> jobs_;
+    std::map<uint64_t, SynthesisResult> done_;  // 重排缓冲区, 按编号排序
+    uint64_t next_seq_ = 0;
+    uint64_t next_release_ = 0;
+    bool closed_ = false;
+
+    uint64_t synthesized_ = 0;  // 以下由 mutex_ 保护, 只计实际推理的句子
+    uint64_t infer_ms_ = 0;
+    uint64_t audio_ms_ = 0;
+    uint64_t trimmed_ms_ = 0;   // 合成结果去掉的首尾静音
+};
+
+#endif  // SYNTHESIS_POOL_H
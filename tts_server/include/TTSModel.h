@@ -8,6 +8,8 @@
 #include "utils.h"
 #include "Hanz2Piny.h"
 #include "hanzi2phoneid.h"
+#include "ModelWeights.h"
+#include "PcmClip.h"
 #include <iostream>
 #include <fstream>
 
@@ -16,17 +18,26 @@ class SynthesizerTrn;
 
 class TTSModel {
 public:
+    // 当前只用单一音色和默认语速
+    static constexpr int32_t kSpeakerId = 0;
+    static constexpr float kLengthScale = 1.0f;
+    // SummerTTS 输出单声道 16kHz
+    static constexpr unsigned int kSampleRate = 16000;
+
     explicit TTSModel(const std::string& model_path);
+    // 多个实例共享同一份权重
+    explicit TTSModel(std::shared_ptr<ModelWeights> weights);
     ~TTSModel();
     
     bool load_model(const std::string& model_path);
     int16_t* infer(const std::string& text, int32_t& audio_len);
     void free_data(int16_t* data);
+    // 直接接管合成器分配的输出缓冲区, 最后一个引用释放时交还 tts_free_data, 不复制
+    PcmClip synthesize(const std::string& text);
     
 private:
-    float* dataW_ = nullptr;
-    int32_t modelSize_ = 0;
+    std::shared_ptr<ModelWeights> weights_;
     std::unique_ptr<SynthesizerTrn> synthesizer_;
 };
 
-#endif // TTS_MODEL_H
\ No newline at end of file
+#endif // TTS_MODEL_H
@@ -1,14 +1,52 @@
 #ifndef TEXT_PROCESSOR_H
 #define TEXT_PROCESSOR_H
 
+#include <cstddef>
+#include <mutex>
 #include <string>
 #include <vector>
 
+// 一段回答的切块策略 (码点数). 第一块短, 尽快合成出声; 之后每块上限按实时率放大:
+// 单线程合成时第 k 块要在前面已合成的音频播完前合成好, 即 n_k <= n_{k-1} / rtf
+struct ChunkPolicy {
+    size_t first_chars = 8;     // 第一块上限, 0 表示不切块, 整句合成
+    size_t max_chars = 40;      // 每块上限, 超出且没有标点时才在码点边界硬切
+    size_t min_tail = 4;        // 切完剩下不足这么多时并入前一块, 避免孤字
+    double initial_rtf = 0.5;   // 还没有实测时假定的实时率
+    double safety = 0.8;        // 放大倍数 = safety / rtf, 给推理抖动留余量
+    double max_growth = 3.0;
+};
+
+// 跨句子的切块状态: 分发线程切块, 交付线程回报实测推理速度, 内部加锁
+class ChunkPlanner {
+public:
+    explicit ChunkPlanner(ChunkPolicy policy = ChunkPolicy());
+
+    // 新回答开始, 下一块回到 first_chars
+    void begin_answer();
+    // 只在标点 (、，；：。！？等) 之后切分, 标点留在块尾保留停顿
+    std::vector<std::string> split(const std::string &text);
+    // 实测一块的推理耗时和音频时长, 指数平均后决定后续块的放大倍数.
+    // 放大倍数只取固定档位, 实时率小幅波动时同一回答的切块不变, 按块文本缓存的音频才能命中
+    void observe(double infer_ms, double audio_ms);
+
+    double rtf() const;
+    double growth() const;
+
+private:
+    ChunkPolicy policy_;
+    mutable std::mutex mutex_;
+    size_t limit_;
+    double rtf_;
+    double growth_;
+};
+
 class TextProcessor {
 public:
     static std::string extract_after_think(const std::string &input);
     static std::string clean_text(const std::string &text);
+    // 按默认策略切块 (整段视为一段回答的开头) 后逐块清洗
     static std::vector<std::string> process_input_text(const std::string &input);
 };
 
-#endif // TEXT_PROCESSOR_H
\ No newline at end of file
+#endif // TEXT_PROCESSOR_H
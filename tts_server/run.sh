@@ -33,4 +33,4 @@ echo "模型路径: $MODEL_PATH"
 echo "======================================"
 
 # 运行 tts_server
-"${SCRIPT_DIR}/build/tts_server" "$MODEL_PATH"
+"${SCRIPT_DIR}/build/tts_server" "$MODEL_PATH" "${@:2}"
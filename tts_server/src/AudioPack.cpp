@@ -0,0 +1,198 @@
+#include "AudioPack.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <tuple>
+
+namespace {
+
+// 文件布局: 文件头, 按 (chunk_id, sentence) 排序的索引表, 各句 PCM 依次排列
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t codec;  // 0: 单声道 S16 PCM
+    uint64_t entry_count;
+};
+
+struct PackEntry {
+    uint32_t chunk_id;
+    uint32_t sentence;
+    uint32_t text_hash;
+    uint32_t sentence_count;  // 该片段的总句数
+    uint64_t offset;   // 相对文件开头的字节偏移
+    uint64_t samples;
+};
+
+const char kPackMagic[4] = {'A', 'P', 'K', '1'};
+const uint32_t kPackVersion = 1;
+
+}  // namespace
+
+std::shared_ptr<AudioPack> AudioPack::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[audio pack] cannot open " << path << std::endl;
+        return nullptr;
+    }
+
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(PackHeader))
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[audio pack] cannot map " << path << std::endl;
+        return nullptr;
+    }
+
+    size_t size = st.st_size;
+    std::shared_ptr<AudioPack> pack(new AudioPack());
+    pack->mapping_ = std::shared_ptr<const void>(addr, [size](const void *p) {
+        munmap(const_cast<void *>(p), size);
+    });
+    pack->base_ = static_cast<const char *>(addr);
+    pack->size_ = size;
+
+    PackHeader header;
+    memcpy(&header, addr, sizeof(header));
+    if (memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 ||
+        header.version != kPackVersion || header.codec != 0 ||
+        header.entry_count > (size - sizeof(PackHeader)) / sizeof(PackEntry)) {
+        std::cerr << "[audio pack] invalid file " << path << std::endl;
+        return nullptr;
+    }
+    pack->entry_count_ = header.entry_count;
+    pack->sample_rate_ = header.sample_rate;
+
+    // 启动时校验一遍偏移, 之后查询不再检查越界
+    const PackEntry *entries = reinterpret_cast<const PackEntry *>(pack->base_ + sizeof(header));
+    for (size_t i = 0; i < pack->entry_count_; ++i) {
+        const PackEntry &e = entries[i];
+        if (e.offset % sizeof(int16_t) != 0 || e.offset > size ||
+            e.samples > (size - e.offset) / sizeof(int16_t)) {
+            std::cerr << "[audio pack] corrupted entry " << i << " in " << path << std::endl;
+            return nullptr;
+        }
+    }
+
+    std::cout << "[audio pack] " << path << " sentences=" << pack->entry_count_
+              << " size=" << size / 1024 << "KB" << std::endl;
+    return pack;
+}
+
+std::vector<PcmClip> AudioPack::chunk(uint32_t chunk_id, uint32_t text_hash) const
+{
+    const PackEntry *begin = reinterpret_cast<const PackEntry *>(base_ + sizeof(PackHeader));
+    const PackEntry *end = begin + entry_count_;
+    const PackEntry *it = std::lower_bound(begin, end, chunk_id,
+        [](const PackEntry &e, uint32_t id) { return e.chunk_id < id; });
+
+    // 哈希不一致或缺句 (离线合成失败) 都按未命中处理, 不播半段
+    std::vector<PcmClip> clips;
+    for (; it != end && it->chunk_id == chunk_id; ++it) {
+        if (it->text_hash != text_hash || it->sentence != clips.size())
+            return {};
+
+        PcmClip clip;
+        clip.samples = std::shared_ptr<const int16_t>(
+            mapping_, reinterpret_cast<const int16_t *>(base_ + it->offset));
+        clip.length = it->samples;
+        clips.push_back(std::move(clip));
+        if (clips.size() == it->sentence_count)
+            return clips;
+    }
+    return {};
+}
+
+uint32_t AudioPack::text_hash(const std::string &text)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::string AudioPack::play_command(uint32_t chunk_id, uint32_t text_hash)
+{
+    char command[48];
+    snprintf(command, sizeof(command), "<play chunk=%u hash=%08x>", chunk_id, text_hash);
+    return command;
+}
+
+bool AudioPack::parse_play(const std::string &command, uint32_t &chunk_id, uint32_t &text_hash)
+{
+    unsigned int id = 0;
+    unsigned int hash = 0;
+    char close = 0;
+    if (sscanf(command.c_str(), "<play chunk=%u hash=%x%c", &id, &hash, &close) != 3 ||
+        close != '>') {
+        return false;
+    }
+    chunk_id = id;
+    text_hash = hash;
+    return true;
+}
+
+void AudioPackWriter::add(uint32_t chunk_id, uint32_t sentence, uint32_t sentence_count,
+                          uint32_t text_hash, const int16_t *samples, size_t length)
+{
+    sentences_.push_back(Sentence{chunk_id, sentence, sentence_count, text_hash,
+                                  std::vector<int16_t>(samples, samples + length)});
+}
+
+bool AudioPackWriter::write(const std::string &path, uint32_t sample_rate) const
+{
+    std::vector<const Sentence *> order;
+    for (const auto &s : sentences_)
+        order.push_back(&s);
+    std::sort(order.begin(), order.end(), [](const Sentence *a, const Sentence *b) {
+        return std::tie(a->chunk_id, a->index) < std::tie(b->chunk_id, b->index);
+    });
+
+    PackHeader header;
+    memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.sample_rate = sample_rate;
+    header.codec = 0;
+    header.entry_count = order.size();
+
+    std::vector<PackEntry> entries;
+    uint64_t offset = sizeof(PackHeader) + order.size() * sizeof(PackEntry);
+    for (const Sentence *s : order) {
+        entries.push_back(PackEntry{s->chunk_id, s->index, s->text_hash, s->count, offset,
+                                    s->samples.size()});
+        offset += s->samples.size() * sizeof(int16_t);
+    }
+
+    std::string tmp = path + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(entries.data(), sizeof(PackEntry), entries.size(), fp) == entries.size();
+    for (const Sentence *s : order) {
+        if (!ok)
+            break;
+        ok = fwrite(s->samples.data(), sizeof(int16_t), s->samples.size(), fp) ==
+             s->samples.size();
+    }
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
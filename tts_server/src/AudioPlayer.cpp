@@ -1,7 +1,11 @@
 #include "AudioPlayer.h"
+
+#include <algorithm>
 #include <iostream>
 
-AudioPlayer::AudioPlayer()
+AudioPlayer::AudioPlayer(unsigned int sample_rate, unsigned int latency_us)
+    : sample_rate_(sample_rate), latency_us_(latency_us),
+      period_size_(sample_rate / 100)
 {
     initialize();
 }
@@ -23,56 +27,141 @@ bool AudioPlayer::initialize()
         return false;
     }
 
+    err = snd_pcm_set_params(pcm_handle_,
+                             SND_PCM_FORMAT_S16_LE,
+                             SND_PCM_ACCESS_RW_INTERLEAVED,
+                             1,
+                             sample_rate_,
+                             1,
+                             latency_us_);
+    if (err < 0)
+    {
+        std::cerr << "ALSA Error: Cannot set parameters: " << snd_strerror(err) << std::endl;
+        cleanup();
+        return false;
+    }
+
+    err = snd_pcm_get_params(pcm_handle_, &buffer_size_, &period_size_);
+    if (err < 0 || period_size_ == 0)
+    {
+        std::cerr << "ALSA Error: Cannot get buffer size: " << snd_strerror(err) << std::endl;
+        cleanup();
+        return false;
+    }
+    silence_.assign(period_size_, 0);
+
+    std::cout << "[player] " << sample_rate_ << "Hz buffer=" << buffer_size_
+              << " period=" << period_size_ << " frames" << std::endl;
     initialized_ = true;
     return true;
 }
 
-void AudioPlayer::play(const int16_t *audioData, int audio_len, float speed)
+bool AudioPlayer::recover(int err)
 {
-    if (!initialized_ || !pcm_handle_)
-        return;
+    if (err == -EPIPE)
+        ++underruns_;
 
-    unsigned int sample_rate = static_cast<unsigned int>(16000 * speed);
-    int err = snd_pcm_set_params(pcm_handle_,
-                                 SND_PCM_FORMAT_S16_LE,
-                                 SND_PCM_ACCESS_RW_INTERLEAVED,
-                                 1,
-                                 sample_rate,
-                                 1,
-                                 50000);
+    // 处理欠载 (-EPIPE)、挂起 (-ESTRPIPE) 和被信号打断 (-EINTR)
+    err = snd_pcm_recover(pcm_handle_, err, 1);
     if (err < 0)
     {
-        std::cerr << "ALSA Error: Cannot set parameters: " << snd_strerror(err) << std::endl;
-        return;
+        std::cerr << "ALSA Error: Cannot recover: " << snd_strerror(err) << std::endl;
+        return false;
     }
+    return true;
+}
 
-    const snd_pcm_uframes_t frames = audio_len / 2;
-    const int max_retries = 3;
-    int retry_count = 0;
+void AudioPlayer::write(const int16_t *samples, size_t frames)
+{
+    if (!initialized_)
+        return;
 
-    while (true)
+    while (frames > 0)
     {
-        err = snd_pcm_writei(pcm_handle_, audioData, frames);
-        if (err == -EPIPE)
+        snd_pcm_uframes_t chunk = std::min<snd_pcm_uframes_t>(frames, period_size_);
+        snd_pcm_sframes_t written = snd_pcm_writei(pcm_handle_, samples, chunk);
+        if (written < 0)
         {
-            if (++retry_count >= max_retries)
-                break;
-            snd_pcm_prepare(pcm_handle_);
+            if (!recover(static_cast<int>(written)))
+                return;
+            continue;
         }
-        else if (err < 0)
+        samples += written;
+        frames -= written;
+    }
+}
+
+snd_pcm_sframes_t AudioPlayer::queued_frames()
+{
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm_handle_);
+    if (avail < 0)
+        return avail;
+    return static_cast<snd_pcm_sframes_t>(buffer_size_) - avail;
+}
+
+void AudioPlayer::keep_alive()
+{
+    if (!initialized_)
+        return;
+
+    switch (snd_pcm_state(pcm_handle_))
+    {
+    case SND_PCM_STATE_PREPARED:
+        // 写入的音频不足以触发自动启动 (短于一个缓冲), 先播出去
+        if (queued_frames() > 0)
+            snd_pcm_start(pcm_handle_);
+        break;
+    case SND_PCM_STATE_RUNNING:
+    {
+        snd_pcm_sframes_t queued = queued_frames();
+        if (queued < 0)
         {
-            break;
+            recover(static_cast<int>(queued));
         }
-        else
+        else if (queued < static_cast<snd_pcm_sframes_t>(2 * period_size_))
         {
-            break;
+            write(silence_.data(), silence_.size());
+            silence_frames_ += silence_.size();
         }
+        break;
+    }
+    case SND_PCM_STATE_XRUN:
+        recover(-EPIPE);
+        break;
+    default:
+        break;
     }
+}
+
+void AudioPlayer::drain()
+{
+    if (!initialized_)
+        return;
 
-    if (snd_pcm_state(pcm_handle_) == SND_PCM_STATE_RUNNING)
+    snd_pcm_state_t state = snd_pcm_state(pcm_handle_);
+    if (state == SND_PCM_STATE_RUNNING ||
+        (state == SND_PCM_STATE_PREPARED && queued_frames() > 0))
     {
         snd_pcm_drain(pcm_handle_);
     }
+    // drain 后设备回到 SETUP 状态, 欠载后处于 XRUN 状态, 都需要 prepare 才能再写
+    if (snd_pcm_state(pcm_handle_) != SND_PCM_STATE_PREPARED)
+        snd_pcm_prepare(pcm_handle_);
+}
+
+void AudioPlayer::drop()
+{
+    if (!initialized_)
+        return;
+
+    snd_pcm_drop(pcm_handle_);
+    snd_pcm_prepare(pcm_handle_);
+}
+
+void AudioPlayer::print_stats() const
+{
+    std::cout << "[player stats] underruns=" << underruns_ << " silence="
+              << silence_frames_ * 1000 / sample_rate_ << "ms" << std::endl;
 }
 
 void AudioPlayer::cleanup()
@@ -83,4 +172,4 @@ void AudioPlayer::cleanup()
         pcm_handle_ = nullptr;
     }
     initialized_ = false;
-}
\ No newline at end of file
+}
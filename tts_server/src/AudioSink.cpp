@@ -0,0 +1,144 @@
+#include "AudioSink.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "AudioPlayer.h"
+
+std::unique_ptr<AudioSink> AudioSink::create(const std::string& spec, unsigned int sample_rate)
+{
+    // 打不开设备时 write/drain 都是空操作, 却会照常通知 voice 播放完成, 不能交给调用方
+    if (spec == "alsa") {
+        std::unique_ptr<AudioPlayer> player(new AudioPlayer(sample_rate));
+        if (!player->is_open())
+            return nullptr;
+        return player;
+    }
+    if (spec == "null")
+        return std::unique_ptr<AudioSink>(new NullSink(sample_rate, true));
+    if (spec == "null-fast")
+        return std::unique_ptr<AudioSink>(new NullSink(sample_rate, false));
+    if (spec.compare(0, 4, "wav:") == 0 && spec.size() > 4) {
+        std::unique_ptr<WavSink> sink(new WavSink(spec.substr(4), sample_rate));
+        if (!sink->is_open())
+            return nullptr;
+        return sink;
+    }
+    return nullptr;
+}
+
+NullSink::NullSink(unsigned int sample_rate, bool realtime)
+    : sample_rate_(sample_rate), realtime_(realtime)
+{
+}
+
+void NullSink::write(const int16_t*, size_t frames)
+{
+    frames_ += frames;
+    if (!realtime_)
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (!playing_ || play_until_ < now) {
+        if (playing_)
+            ++underruns_;
+        play_until_ = now;
+        playing_ = true;
+    }
+    play_until_ += std::chrono::microseconds(1000000ULL * frames / sample_rate_);
+
+    // 模拟 50ms 设备缓冲: 缓冲满了才阻塞
+    std::this_thread::sleep_until(play_until_ - std::chrono::milliseconds(50));
+}
+
+void NullSink::drain()
+{
+    if (realtime_ && playing_)
+        std::this_thread::sleep_until(play_until_);
+    playing_ = false;
+}
+
+void NullSink::drop()
+{
+    playing_ = false;
+}
+
+void NullSink::print_stats() const
+{
+    std::cout << "[null sink] played=" << frames_ * 1000 / sample_rate_ << "ms"
+              << " underruns=" << underruns_ << std::endl;
+}
+
+WavSink::WavSink(const std::string& path, unsigned int sample_rate)
+    : path_(path), sample_rate_(sample_rate)
+{
+    fp_ = fopen(path.c_str(), "wb");
+    if (!fp_) {
+        std::cerr << "[wav sink] cannot open " << path << std::endl;
+        return;
+    }
+    update_header();
+}
+
+WavSink::~WavSink()
+{
+    if (fp_) {
+        update_header();
+        fclose(fp_);
+    }
+}
+
+void WavSink::write(const int16_t* samples, size_t frames)
+{
+    if (!fp_)
+        return;
+    frames_ += fwrite(samples, sizeof(int16_t), frames, fp_);
+}
+
+void WavSink::drain()
+{
+    if (fp_)
+        update_header();
+}
+
+// 44 字节的标准 PCM WAV 头, 小端
+void WavSink::update_header()
+{
+    auto put16 = [](unsigned char* p, uint16_t v) {
+        p[0] = v & 0xff;
+        p[1] = v >> 8;
+    };
+    auto put32 = [](unsigned char* p, uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            p[i] = (v >> (8 * i)) & 0xff;
+    };
+
+    uint32_t data_bytes = static_cast<uint32_t>(frames_ * sizeof(int16_t));
+    unsigned char header[44];
+    memcpy(header, "RIFF", 4);
+    put32(header + 4, 36 + data_bytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(header + 16, 16);
+    put16(header + 20, 1);  // PCM
+    put16(header + 22, 1);  // 单声道
+    put32(header + 24, sample_rate_);
+    put32(header + 28, sample_rate_ * sizeof(int16_t));
+    put16(header + 32, sizeof(int16_t));
+    put16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, data_bytes);
+
+    long pos = ftell(fp_);
+    fseek(fp_, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), fp_);
+    if (pos > static_cast<long>(sizeof(header)))
+        fseek(fp_, pos, SEEK_SET);
+    fflush(fp_);
+}
+
+void WavSink::print_stats() const
+{
+    std::cout << "[wav sink] " << path_ << " " << frames_ * 1000 / sample_rate_ << "ms"
+              << std::endl;
+}
@@ -1,59 +1,111 @@
 #include "MessageQueue.h"
 
-void DoubleMessageQueue::push_text(const std::string &msg)
+#include <algorithm>
+#include <iostream>
+
+DoubleMessageQueue::DoubleMessageQueue(size_t text_capacity, size_t audio_capacity)
+    : text_ring_(text_capacity), audio_ring_(audio_capacity)
 {
-    {
-        std::lock_guard<std::mutex> lock(text_mutex_);
-        text_queue_.push(msg);
-    }
-    text_cond_.notify_one();
 }
 
-std::string DoubleMessageQueue::pop_text()
+bool DoubleMessageQueue::push_text(const std::string &msg)
+{
+    TextMessage item{msg, epoch_.load(std::memory_order_acquire)};
+    return text_ring_.try_push(item);
+}
+
+bool DoubleMessageQueue::pop_text(std::string &text, uint64_t &epoch)
 {
-    std::unique_lock<std::mutex> lock(text_mutex_);
-    text_cond_.wait(lock, [this]
-                    { return !text_queue_.empty() || stop_; });
+    TextMessage item;
+    while (text_ring_.pop(item)) {
+        if (item.epoch != epoch_.load(std::memory_order_acquire)) {
+            ++dropped_;
+            continue;
+        }
+        text = std::move(item.text);
+        epoch = item.epoch;
+        return true;
+    }
+    return false;
+}
 
-    if (stop_)
-        return "";
+bool DoubleMessageQueue::push_audio(PcmClip audio, bool is_last, uint64_t epoch,
+                                    uint32_t pause_ms)
+{
+    if (epoch != epoch_.load(std::memory_order_acquire)) {
+        ++dropped_;
+        return false;
+    }
+    return audio_ring_.push(AudioMessage{std::move(audio), is_last, epoch, pause_ms});
+}
 
-    std::string msg = std::move(text_queue_.front());
-    text_queue_.pop();
-    return msg;
+void DoubleMessageQueue::close_audio()
+{
+    audio_ring_.close();
 }
 
-void DoubleMessageQueue::push_audio(std::unique_ptr<int16_t[]> data, size_t length, bool is_last)
+bool DoubleMessageQueue::pop_audio(AudioMessage &msg)
 {
-    AudioMessage msg{std::move(data), length, is_last};
-    {
-        std::lock_guard<std::mutex> lock(audio_mutex_);
-        audio_queue_.push(std::move(msg));
+    while (audio_ring_.pop(msg)) {
+        if (msg.epoch == epoch_.load(std::memory_order_acquire))
+            return true;
+        ++dropped_;
     }
-    audio_cond_.notify_one();
+    return false;
 }
 
-AudioMessage DoubleMessageQueue::pop_audio()
+RingPop DoubleMessageQueue::pop_audio_for(AudioMessage &msg, std::chrono::microseconds timeout)
 {
-    std::unique_lock<std::mutex> lock(audio_mutex_);
-    audio_cond_.wait(lock, [this]
-                     { return !audio_queue_.empty() || stop_; });
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - std::chrono::steady_clock::now());
+        RingPop result = audio_ring_.pop_for(msg, std::max(left, std::chrono::microseconds(0)));
+        if (result != RingPop::kOk || msg.epoch == epoch_.load(std::memory_order_acquire))
+            return result;
+        ++dropped_;
+    }
+}
 
-    if (stop_)
-        return {nullptr, 0, true};
+void DoubleMessageQueue::clear()
+{
+    epoch_.fetch_add(1, std::memory_order_acq_rel);
+    open_answers_.store(0, std::memory_order_release);
+}
 
-    AudioMessage msg = std::move(audio_queue_.front());
-    audio_queue_.pop();
-    return msg;
+void DoubleMessageQueue::answer_played()
+{
+    // 与 clear() 并发时可能已归零, 不减到负数
+    uint64_t open = open_answers_.load(std::memory_order_acquire);
+    while (open > 0 &&
+           !open_answers_.compare_exchange_weak(open, open - 1, std::memory_order_acq_rel)) {
+    }
 }
 
-void DoubleMessageQueue::stop()
+void DoubleMessageQueue::stop(StopMode mode)
 {
-    {
-        std::lock_guard<std::mutex> lock1(text_mutex_);
-        std::lock_guard<std::mutex> lock2(audio_mutex_);
-        stop_ = true;
+    if (mode == StopMode::kAbort) {
+        text_ring_.abort();
+        audio_ring_.abort();
+    } else {
+        // 音频队列由合成线程取完文本后关闭, 保证已收到的文本都能播出
+        text_ring_.close();
     }
-    text_cond_.notify_all();
-    audio_cond_.notify_all();
-}
\ No newline at end of file
+}
+
+static void print_ring(const char *name, const RingStats &s)
+{
+    double avg_us = s.pop_waits ? s.pop_wait_ns / 1000.0 / s.pop_waits : 0.0;
+    std::cout << " " << name << ": depth=" << s.depth << " max_depth=" << s.max_depth
+              << " pushes=" << s.pushes << " pop_waits=" << s.pop_waits << " avg_wait=" << avg_us
+              << "us max_wait=" << s.pop_wait_max_ns / 1000.0 << "us full_waits=" << s.push_waits
+              << " full_wait=" << s.push_wait_ns / 1000.0 << "us";
+}
+
+void DoubleMessageQueue::print_stats() const
+{
+    std::cout << "[queue stats]";
+    print_ring("text", text_ring_.stats());
+    print_ring("audio", audio_ring_.stats());
+    std::cout << " dropped=" << dropped_ << std::endl;
+}
@@ -0,0 +1,59 @@
+#include "ModelWeights.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "utils.h"
+
+std::shared_ptr<ModelWeights> ModelWeights::load(const std::string &model_path)
+{
+    std::shared_ptr<ModelWeights> weights(new ModelWeights());
+
+    int fd = ::open(model_path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0 &&
+        st.st_size <= std::numeric_limits<int32_t>::max()) {
+        void *addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            weights->data_ = static_cast<float *>(addr);
+            weights->size_ = static_cast<int32_t>(st.st_size);
+            weights->map_length_ = st.st_size;
+            weights->mapped_ = true;
+        } else {
+            std::cerr << "[TTS model] mmap failed: " << strerror(errno) << std::endl;
+        }
+    }
+    if (fd >= 0)
+        ::close(fd);
+
+    if (!weights->mapped_) {
+        std::vector<char> path_copy(model_path.begin(), model_path.end());
+        path_copy.push_back('\0');
+        weights->size_ = ttsLoadModel(path_copy.data(), &weights->data_);
+        if (weights->size_ <= 0 || !weights->data_) {
+            std::cerr << "[TTS model] cannot load " << model_path << std::endl;
+            return nullptr;
+        }
+    }
+
+    std::cout << "[TTS model] " << model_path << " " << weights->size_ / 1024 << "KB "
+              << (weights->mapped_ ? "mapped" : "loaded") << std::endl;
+    return weights;
+}
+
+ModelWeights::~ModelWeights()
+{
+    if (mapped_) {
+        munmap(data_, map_length_);
+    } else if (data_) {
+        tts_free_data(data_);
+    }
+}
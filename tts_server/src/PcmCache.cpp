@@ -0,0 +1,225 @@
+#include "PcmCache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// 磁盘层文件: 文件头 + key (补齐到 8 字节) + 单声道 S16 样本
+struct DiskHeader {
+    char magic[4];
+    uint32_t key_length;
+    uint32_t infer_ms;
+    uint32_t reserved;
+    uint64_t samples;
+};
+
+const char kDiskMagic[4] = {'P', 'C', 'M', '1'};
+
+size_t padded(size_t n)
+{
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+uint64_t fnv1a(const std::string &s)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+PcmCache::PcmCache(PcmCacheConfig config) : config_(std::move(config))
+{
+    if (enabled() && !config_.disk_dir.empty())
+        mkdir(config_.disk_dir.c_str(), 0755);
+}
+
+std::string PcmCache::make_key(const std::string &text, int32_t speaker_id, float speed)
+{
+    std::string key;
+    key.reserve(text.size() + 16);
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            key += c;
+    }
+
+    char params[32];
+    snprintf(params, sizeof(params), "\x1f%d\x1f%.2f", speaker_id, speed);
+    return key + params;
+}
+
+bool PcmCache::lookup(const std::string &key, PcmClip &clip)
+{
+    if (!enabled())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            clip = it->second->clip;
+            ++memory_hits_;
+            saved_ms_ += it->second->infer_ms;
+            return true;
+        }
+    }
+
+    // 磁盘 I/O 不持锁
+    uint32_t infer_ms = 0;
+    if (!config_.disk_dir.empty() && load_from_disk(key, clip, infer_ms)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        insert_locked(key, clip, infer_ms);
+        ++disk_hits_;
+        saved_ms_ += infer_ms;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    return false;
+}
+
+void PcmCache::insert(const std::string &key, const PcmClip &clip, uint32_t infer_ms)
+{
+    if (!enabled() || clip.empty())
+        return;
+
+    if (!config_.disk_dir.empty())
+        save_to_disk(key, clip, infer_ms);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert_locked(key, clip, infer_ms);
+}
+
+void PcmCache::insert_locked(const std::string &key, const PcmClip &clip, uint32_t infer_ms)
+{
+    // 裁剪后的音频仍持有合成器的整块输出, 按整块计入预算
+    size_t bytes = clip.memory_bytes() + key.size();
+    if (bytes > config_.max_bytes)
+        return;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->bytes;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    entries_.push_front(Entry{key, clip, infer_ms, bytes});
+    index_[key] = entries_.begin();
+    bytes_ += bytes;
+
+    while (bytes_ > config_.max_bytes) {
+        Entry &oldest = entries_.back();
+        bytes_ -= oldest.bytes;
+        index_.erase(oldest.key);
+        entries_.pop_back();
+    }
+}
+
+std::string PcmCache::disk_path(const std::string &key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.pcm", static_cast<unsigned long long>(fnv1a(key)));
+    return config_.disk_dir + name;
+}
+
+bool PcmCache::load_from_disk(const std::string &key, PcmClip &clip, uint32_t &infer_ms) const
+{
+    int fd = ::open(disk_path(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > sizeof(DiskHeader))
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+
+    // 映射随最后一个引用释放
+    size_t size = st.st_size;
+    std::shared_ptr<const void> mapping(addr, [size](const void *p) {
+        munmap(const_cast<void *>(p), size);
+    });
+
+    DiskHeader header;
+    memcpy(&header, addr, sizeof(header));
+    const char *base = static_cast<const char *>(addr);
+    size_t offset = sizeof(DiskHeader) + padded(header.key_length);
+    // 校验 key 本身, 哈希冲突或文件被截断时视为未命中
+    if (memcmp(header.magic, kDiskMagic, sizeof(kDiskMagic)) != 0 ||
+        header.key_length != key.size() || offset > size ||
+        header.samples != (size - offset) / sizeof(int16_t) ||
+        memcmp(base + sizeof(DiskHeader), key.data(), key.size()) != 0) {
+        return false;
+    }
+
+    clip.samples = std::shared_ptr<const int16_t>(
+        mapping, reinterpret_cast<const int16_t *>(base + offset));
+    clip.length = header.samples;
+    clip.buffer_bytes = size;
+    infer_ms = header.infer_ms;
+    return true;
+}
+
+void PcmCache::save_to_disk(const std::string &key, const PcmClip &clip, uint32_t infer_ms) const
+{
+    DiskHeader header;
+    memcpy(header.magic, kDiskMagic, sizeof(kDiskMagic));
+    header.key_length = static_cast<uint32_t>(key.size());
+    header.infer_ms = infer_ms;
+    header.reserved = 0;
+    header.samples = clip.length;
+
+    // 先写临时文件再改名, 其他进程不会读到写了一半的文件
+    std::string path = disk_path(key);
+    std::ostringstream tmp;
+    tmp << path << ".tmp." << std::this_thread::get_id();
+    FILE *fp = fopen(tmp.str().c_str(), "wb");
+    if (!fp)
+        return;
+
+    static const char kZeros[8] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(key.data(), 1, key.size(), fp) == key.size() &&
+              fwrite(kZeros, 1, padded(key.size()) - key.size(), fp) ==
+                  padded(key.size()) - key.size() &&
+              fwrite(clip.samples.get(), sizeof(int16_t), clip.length, fp) == clip.length;
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmp.str().c_str(), path.c_str()) != 0) {
+        std::cerr << "[TTS cache] cannot write " << path << std::endl;
+        unlink(tmp.str().c_str());
+    }
+}
+
+void PcmCache::print_stats() const
+{
+    if (!enabled())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t lookups = memory_hits_ + disk_hits_ + misses_;
+    double hit_rate = lookups ? 100.0 * (memory_hits_ + disk_hits_) / lookups : 0.0;
+    std::cout << "[TTS cache] entries=" << entries_.size() << " bytes=" << bytes_
+              << " memory_hits=" << memory_hits_ << " disk_hits=" << disk_hits_
+              << " misses=" << misses_ << " hit_rate=" << hit_rate
+              << "% saved_infer=" << saved_ms_ << "ms" << std::endl;
+}
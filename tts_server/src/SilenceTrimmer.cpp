@@ -0,0 +1,79 @@
+#include "SilenceTrimmer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+SilenceTrimmer::SilenceTrimmer(SilenceTrimConfig config, unsigned int sample_rate)
+    : config_(config), sample_rate_(sample_rate)
+{
+}
+
+PcmClip SilenceTrimmer::trim(const PcmClip &clip) const
+{
+    if (!config_.enabled || clip.empty())
+        return clip;
+
+    // 每 10ms 一帧的均方能量
+    const size_t frame = std::max(1u, sample_rate_ / 100);
+    const int16_t *samples = clip.samples.get();
+    std::vector<uint64_t> energy((clip.length + frame - 1) / frame);
+    uint64_t peak = 0;
+    for (size_t f = 0; f < energy.size(); ++f) {
+        size_t begin = f * frame;
+        size_t end = std::min(clip.length, begin + frame);
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; ++i)
+            sum += static_cast<int64_t>(samples[i]) * samples[i];
+        energy[f] = sum / (end - begin);
+        peak = std::max(peak, energy[f]);
+    }
+    if (peak == 0)
+        return clip;
+
+    const double threshold =
+        std::min<double>(peak, peak * std::pow(10.0, config_.threshold_db / 10.0));
+    size_t first = 0;
+    while (energy[first] < threshold)
+        ++first;
+    size_t last = energy.size() - 1;
+    while (energy[last] < threshold)
+        --last;
+
+    size_t lead = static_cast<size_t>(sample_rate_) * config_.lead_ms / 1000;
+    size_t tail = static_cast<size_t>(sample_rate_) * config_.tail_ms / 1000;
+    size_t start = first * frame > lead ? first * frame - lead : 0;
+    size_t end = std::min(clip.length, (last + 1) * frame + tail);
+
+    PcmClip trimmed;
+    trimmed.samples = std::shared_ptr<const int16_t>(clip.samples, samples + start);
+    trimmed.length = end - start;
+    trimmed.buffer_bytes = clip.memory_bytes();
+    return trimmed;
+}
+
+uint32_t SilenceTrimmer::pause_after(const std::string &chunk, bool end_of_sentence) const
+{
+    if (end_of_sentence)
+        return config_.sentence_pause_ms;
+
+    // 最后一个码点
+    size_t pos = chunk.size();
+    while (pos > 0 && (static_cast<unsigned char>(chunk[pos - 1]) & 0xC0) == 0x80)
+        --pos;
+    if (pos == 0)
+        return 0;
+    std::string last = chunk.substr(pos - 1);
+
+    static const char *const kSentenceEnd[] = {"。", "！", "？", "!", "?", "."};
+    static const char *const kPhraseEnd[] = {"，", "、", "；", "：", ",", ";", ":", "\n"};
+    for (const char *p : kSentenceEnd) {
+        if (last == p)
+            return config_.sentence_pause_ms;
+    }
+    for (const char *p : kPhraseEnd) {
+        if (last == p)
+            return config_.phrase_pause_ms;
+    }
+    return 0;
+}
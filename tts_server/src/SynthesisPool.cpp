@@ -0,0 +1,195 @@
+#include "SynthesisPool.h"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+SynthesisPool::SynthesisPool(const std::string &model_path, SynthesisConfig config,
+                             std::function<bool(uint64_t)> stale)
+    : config_(config),
+      stale_(std::move(stale)),
+      cache_(config.cache),
+      trimmer_(config.trim, TTSModel::kSampleRate)
+{
+    if (config_.workers < 1)
+        config_.workers = 1;
+    if (config_.max_ahead < static_cast<size_t>(config_.workers))
+        config_.max_ahead = config_.workers;
+    if (config_.omp_threads <= 0) {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        config_.omp_threads = std::max(1, cores / config_.workers);
+    }
+
+    // 所有合成线程共用一份只读映射的权重, 每个线程只有自己的 SynthesizerTrn
+    std::shared_ptr<ModelWeights> weights = ModelWeights::load(model_path);
+    if (!weights)
+        throw std::runtime_error("cannot load TTS model: " + model_path);
+    for (int i = 0; i < config_.workers; ++i)
+        models_.push_back(std::make_unique<TTSModel>(weights));
+    for (int i = 0; i < config_.workers; ++i)
+        threads_.emplace_back(&SynthesisPool::worker_loop, this, i);
+
+    std::cout << "[TTS pool] workers=" << config_.workers
+              << " omp_threads=" << config_.omp_threads
+              << " max_ahead=" << config_.max_ahead << std::endl;
+}
+
+SynthesisPool::~SynthesisPool()
+{
+    close();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+std::string SynthesisPool::cache_key(const std::string &text)
+{
+    return PcmCache::make_key(text, TTSModel::kSpeakerId, TTSModel::kLengthScale);
+}
+
+bool SynthesisPool::wait_for_space(std::unique_lock<std::mutex> &lock)
+{
+    space_cond_.wait(lock, [this] {
+        return closed_ || next_seq_ - next_release_ < config_.max_ahead;
+    });
+    return !closed_;
+}
+
+bool SynthesisPool::submit(std::string text, bool is_last, uint64_t epoch, uint32_t pause_ms)
+{
+    // 缓存中存的是已去掉静音的结果
+    PcmClip clip;
+    if (!text.empty() && cache_.lookup(cache_key(text), clip)) {
+        std::cout << "[TTS cache] hit: " << text << std::endl;
+        return submit_audio(clip, is_last, epoch, pause_ms);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!wait_for_space(lock))
+        return false;
+
+    Job job;
+    job.seq = next_seq_++;
+    job.text = std::move(text);
+    job.is_last = is_last;
+    job.epoch = epoch;
+    job.pause_ms = pause_ms;
+    jobs_.push_back(std::move(job));
+    job_cond_.notify_one();
+    return true;
+}
+
+bool SynthesisPool::submit_audio(const PcmClip &clip, bool is_last, uint64_t epoch,
+                                 uint32_t pause_ms)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!wait_for_space(lock))
+        return false;
+
+    SynthesisResult result;
+    result.seq = next_seq_++;
+    result.audio = clip;
+    result.is_last = is_last;
+    result.epoch = epoch;
+    result.pause_ms = pause_ms;
+    done_.emplace(result.seq, std::move(result));
+    done_cond_.notify_all();
+    return true;
+}
+
+bool SynthesisPool::next(SynthesisResult &result)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cond_.wait(lock, [this] {
+        return done_.count(next_release_) || (closed_ && next_release_ == next_seq_);
+    });
+
+    auto it = done_.find(next_release_);
+    if (it == done_.end())
+        return false;
+
+    result = std::move(it->second);
+    done_.erase(it);
+    ++next_release_;
+    space_cond_.notify_one();
+    return true;
+}
+
+void SynthesisPool::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    job_cond_.notify_all();
+    done_cond_.notify_all();
+    space_cond_.notify_all();
+}
+
+void SynthesisPool::worker_loop(int index)
+{
+    // OpenMP 线程数是每个线程各自的设置, 只影响本合成线程发起的并行区
+    omp_set_num_threads(config_.omp_threads);
+    TTSModel &model = *models_[index];
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_cond_.wait(lock, [this] { return closed_ || !jobs_.empty(); });
+            if (jobs_.empty())
+                return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        SynthesisResult result;
+        result.seq = job.seq;
+        result.is_last = job.is_last;
+        result.epoch = job.epoch;
+        result.pause_ms = job.pause_ms;
+
+        if (!job.text.empty() && !stale_(job.epoch)) {
+            auto start = std::chrono::steady_clock::now();
+            PcmClip raw = model.synthesize(job.text);
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+            // 缓存只记账有声部分的字节, 被去掉的首尾静音随原缓冲区一起保留到淘汰
+            result.audio = trimmer_.trim(raw);
+            result.infer_ms = static_cast<uint32_t>(ms);
+            cache_.insert(cache_key(job.text), result.audio, result.infer_ms);
+
+            // 实时率按模型输出的完整时长计算, < 1 才能边合成边播放不断音
+            uint64_t audio_ms = raw.length * 1000 / TTSModel::kSampleRate;
+            uint64_t trimmed_ms = (raw.length - result.audio.length) * 1000 / TTSModel::kSampleRate;
+            double rtf = audio_ms ? static_cast<double>(ms) / audio_ms : 0.0;
+            std::cout << "[TTS infer] worker " << index << " #" << job.seq << " " << ms
+                      << "ms audio=" << audio_ms << "ms rtf=" << rtf << " trimmed=" << trimmed_ms
+                      << "ms: " << job.text << std::endl;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++synthesized_;
+            infer_ms_ += ms;
+            audio_ms_ += audio_ms;
+            trimmed_ms_ += trimmed_ms;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.emplace(job.seq, std::move(result));
+        }
+        done_cond_.notify_all();
+    }
+}
+
+void SynthesisPool::print_stats() const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double rtf = audio_ms_ ? static_cast<double>(infer_ms_) / audio_ms_ : 0.0;
+        std::cout << "[TTS pool] synthesized=" << synthesized_ << " infer=" << infer_ms_
+                  << "ms audio=" << audio_ms_ << "ms rtf=" << rtf << " trimmed=" << trimmed_ms_
+                  << "ms" << std::endl;
+    }
+    cache_.print_stats();
+}
@@ -2,31 +2,37 @@
 #include "SynthesizerTrn.h"
 #include "utils.h"
 
+constexpr int32_t TTSModel::kSpeakerId;
+constexpr float TTSModel::kLengthScale;
 
 TTSModel::TTSModel(const std::string &model_path)
 {
     load_model(model_path);
 }
 
-TTSModel::~TTSModel()
+TTSModel::TTSModel(std::shared_ptr<ModelWeights> weights)
+    : weights_(std::move(weights))
 {
-    if (dataW_)
+    if (weights_)
     {
-        tts_free_data(reinterpret_cast<int16_t *>(dataW_));
+        synthesizer_ = std::make_unique<SynthesizerTrn>(weights_->data(), weights_->size());
     }
 }
 
-bool TTSModel::load_model(const std::string &model_path)
+// 先析构 SynthesizerTrn, 再释放它引用的权重
+TTSModel::~TTSModel()
 {
-    std::vector<char> model_path_copy(model_path.begin(), model_path.end());
-    model_path_copy.push_back('\0');
+    synthesizer_.reset();
+}
 
-    modelSize_ = ttsLoadModel(model_path_copy.data(), &dataW_);
-    if (modelSize_ <= 0 || !dataW_)
+bool TTSModel::load_model(const std::string &model_path)
+{
+    weights_ = ModelWeights::load(model_path);
+    if (!weights_)
     {
         return false;
     }
-    synthesizer_ = std::make_unique<SynthesizerTrn>(dataW_, modelSize_);
+    synthesizer_ = std::make_unique<SynthesizerTrn>(weights_->data(), weights_->size());
     return true;
 }
 
@@ -34,7 +40,27 @@ int16_t *TTSModel::infer(const std::string &text, int32_t &audio_len)
 {
     if (!synthesizer_)
         return nullptr;
-    return synthesizer_->infer(text, 0, 1.0, audio_len);
+    return synthesizer_->infer(text, kSpeakerId, kLengthScale, audio_len);
+}
+
+PcmClip TTSModel::synthesize(const std::string &text)
+{
+    PcmClip clip;
+    int32_t audio_len = 0;
+    int16_t *data = infer(text, audio_len);
+    if (!data)
+        return clip;
+    if (audio_len <= 0)
+    {
+        tts_free_data(data);
+        return clip;
+    }
+
+    clip.samples = std::shared_ptr<const int16_t>(data, [](const int16_t *p) {
+        tts_free_data(const_cast<int16_t *>(p));
+    });
+    clip.length = audio_len;
+    return clip;
 }
 
 void TTSModel::free_data(int16_t *data)
@@ -1,9 +1,115 @@
 #include "TextProcessor.h"
 
 #include <algorithm>
-#include <cstdint>
+#include <cmath>
 
-#include "Utils.h"
+#include "Utf8Segmenter.h"
+
+// 前 count 个码点的字节数
+static size_t utf8_prefix_bytes(const std::string &text, size_t count) {
+    size_t i = 0;
+    for (; i < text.size(); ++i) {
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80 && count-- == 0) break;
+    }
+    return i;
+}
+
+// 放大倍数的档位, 超出 max_growth 的档位不用. 至少为 1: 合成跟不上播放时切小也无济于事, 只保持块长
+static const double kGrowthSteps[] = {1.0, 1.5, 2.0, 3.0};
+
+static double growth_step(double target, double max_growth) {
+    double step = kGrowthSteps[0];
+    for (double s : kGrowthSteps) {
+        if (s <= target && s <= max_growth) step = s;
+    }
+    return step;
+}
+
+// 目标倍数越过档位 10% 以上才换档, 实时率在档位边界附近抖动时不来回切换
+static double quantize_growth(double target, double current, double max_growth) {
+    double up   = growth_step(target / 1.1, max_growth);
+    double down = growth_step(target / 0.9, max_growth);
+    return std::min(std::max(current, up), down);
+}
+
+ChunkPlanner::ChunkPlanner(ChunkPolicy policy)
+    : policy_(policy),
+      limit_(policy.first_chars),
+      rtf_(policy.initial_rtf),
+      growth_(growth_step(policy.safety / policy.initial_rtf, policy.max_growth)) {
+    // 上限为 0 时每块切不出字, split() 不会结束; 也不能小于第一块
+    policy_.max_chars = std::max(policy_.max_chars, std::max<size_t>(1, policy_.first_chars));
+}
+
+void ChunkPlanner::begin_answer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    limit_ = policy_.first_chars;
+}
+
+double ChunkPlanner::rtf() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rtf_;
+}
+
+double ChunkPlanner::growth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return growth_;
+}
+
+void ChunkPlanner::observe(double infer_ms, double audio_ms) {
+    if (infer_ms <= 0 || audio_ms <= 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    rtf_    = 0.8 * rtf_ + 0.2 * (infer_ms / audio_ms);
+    growth_ = quantize_growth(policy_.safety / rtf_, growth_, policy_.max_growth);
+}
+
+std::vector<std::string> ChunkPlanner::split(const std::string &text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (policy_.first_chars == 0) return {text};
+
+    // 先按标点切成短语, 没有标点的长串在 max_chars 处按码点硬切
+    text_segmenter::SegmenterConfig config;
+    config.delimiters = "，、；：。！？,;:!?\n";
+    config.max_chars  = policy_.max_chars;
+    std::vector<std::string> phrases = text_segmenter::Utf8Segmenter::split(text, config);
+
+    std::vector<size_t> lengths;
+    size_t remaining = 0;
+    for (const auto &phrase : phrases) {
+        lengths.push_back(text_segmenter::utf8_length(phrase));
+        remaining += lengths.back();
+    }
+
+    std::vector<std::string> chunks;
+    size_t i = 0;
+    while (i < phrases.size()) {
+        // 至少放一个短语; 能装下就继续装, 剩余太短时一并带上.
+        // 单个短语超出上限两倍 (长串没有标点) 时在上限处按码点切开, 否则首块会过长
+        std::string chunk  = phrases[i];
+        size_t chunk_chars = lengths[i];
+        if (chunk_chars > 2 * limit_) {
+            size_t cut = utf8_prefix_bytes(chunk, limit_);
+            phrases[i].erase(0, cut);
+            lengths[i] -= limit_;
+            remaining -= limit_;
+            chunk.resize(cut);
+            chunk_chars = limit_;
+        } else {
+            remaining -= lengths[i++];
+        }
+        while (i < phrases.size() &&
+               (chunk_chars + lengths[i] <= limit_ || remaining < policy_.min_tail)) {
+            chunk += phrases[i];
+            chunk_chars += lengths[i];
+            remaining -= lengths[i++];
+        }
+        chunks.push_back(std::move(chunk));
+
+        size_t next = static_cast<size_t>(std::ceil(chunk_chars * growth_));
+        limit_      = std::min(policy_.max_chars, std::max(limit_, next));
+    }
+    return chunks;
+}
 
 std::string TextProcessor::extract_after_think(const std::string &input) {
     const std::string start_tag = "<think>";
@@ -26,46 +132,27 @@ std::string TextProcessor::extract_after_think(const std::string &input) {
     return result;
 }
 
+// 按码点过滤标点和空白, 不会截断多字节字符
 std::string TextProcessor::clean_text(const std::string &text) {
-    const std::string punct = " \t\n\r*#@$%^&，。：、；！？【】（）“”‘’";
-    std::string filtered;
+    text_segmenter::SegmenterConfig config;
+    config.delimiters  = "";
+    config.strip_chars = " \t\n\r*#@$%^&，。：、；！？【】（）“”‘’";
 
-    for (size_t i = 0; i < text.size();) {
-        uint8_t c = text[i];
-        if (punct.find(c) != std::string::npos) {
-            i++;
-        } else {
-            size_t char_len = 1;
-            if ((c & 0xE0) == 0xC0)
-                char_len = 2;
-            else if ((c & 0xF0) == 0xE0)
-                char_len = 3;
-            else if ((c & 0xF8) == 0xF0)
-                char_len = 4;
-
-            bool is_valid = true;
-            for (size_t j = 1; j < char_len; ++j) {
-                if (i + j >= text.size() || !utils::is_valid_utf8_continuation(text[i + j])) {
-                    is_valid = false;
-                    break;
-                }
-            }
-
-            if (is_valid) {
-                filtered.append(text.substr(i, char_len));
-                i += char_len;
-            } else {
-                i++;
-            }
-        }
+    std::string filtered;
+    for (const auto &segment : text_segmenter::Utf8Segmenter::split(text, config)) {
+        filtered += segment;
     }
-
     return filtered;
 }
 
 std::vector<std::string> TextProcessor::process_input_text(const std::string &input) {
     // std::string processed = extract_after_think(input);
-    std::string processed = input;
-    processed             = clean_text(processed);
-    return utils::split_long_text(processed);
-}
\ No newline at end of file
+    // 先切块再清洗, 切块需要标点位置
+    std::vector<std::string> chunks;
+    ChunkPlanner planner;
+    for (const auto &chunk : planner.split(input)) {
+        std::string cleaned = clean_text(chunk);
+        if (!cleaned.empty()) chunks.push_back(std::move(cleaned));
+    }
+    return chunks;
+}
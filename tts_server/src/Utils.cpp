@@ -4,7 +4,6 @@
 #include <sched.h>
 #include <sys/resource.h>
 
-#include <algorithm>
 #include <cstdint>
 
 namespace utils {
@@ -31,20 +30,4 @@ bool set_realtime_priority(pthread_t thread_id, int priority_level) {
 
 bool is_valid_utf8_continuation(uint8_t c) { return (c & 0xC0) == 0x80; }
 
-std::vector<std::string> split_long_text(const std::string &text, size_t max_length) {
-    std::vector<std::string> segments;
-    size_t size = text.length();
-
-    if (size <= max_length) {
-        segments.push_back(text);
-        return segments;
-    }
-
-    for (size_t i = 0; i < size; i += max_length) {
-        segments.push_back(text.substr(i, max_length));
-    }
-
-    return segments;
-}
-
 }  // namespace utils
\ No newline at end of file
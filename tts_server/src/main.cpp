@@ -1,97 +1,375 @@
-#include "TTSModel.h"
+#include "SynthesisPool.h"
+#include "AudioPack.h"
 #include "MessageQueue.h"
-#include "AudioPlayer.h"
+#include "AudioSink.h"
 #include "TextProcessor.h"
 #include "Utils.h"
-#include "ZmqServer.h"
+#include "ZmqReactor.h"
 
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <thread>
 #include <iostream>
 #include <atomic>
 #include <memory>
+#include <deque>
+#include <vector>
 
-zmq_component::ZmqServer server("tcp://*:7777");
-zmq_component::ZmqServer status_server("tcp://*:6677");
-std::atomic<bool> first_msg(true);
-
-void synthesis_worker(DoubleMessageQueue &queue, TTSModel &model) {
+// 分发线程: 按到达顺序把句子切块后交给合成线程池, 音频包里的片段直接按句交付.
+// 每段回答的第一块切短, 尽早出声
+void dispatch_worker(DoubleMessageQueue &queue, SynthesisPool &pool,
+                     std::shared_ptr<AudioPack> pack, ChunkPlanner &planner) {
     // utils::set_realtime_priority(pthread_self(), 99);
 
-    while (true) {
-        std::string text = queue.pop_text();
-        if (text.empty()) break;
+    std::string text;
+    uint64_t epoch = 0;
+    uint64_t answer_epoch = 0;
+    bool in_answer = false;
+    while (queue.pop_text(text, epoch)) {
+        if (text.empty()) continue;
 
+        // 播放命令代表一段完整回答, 最后一句即回答结束
+        uint32_t chunk_id = 0, text_hash = 0;
+        if (pack && AudioPack::parse_play(text, chunk_id, text_hash)) {
+            std::vector<PcmClip> clips = pack->chunk(chunk_id, text_hash);
+            std::cout << "[TTS pack] chunk " << chunk_id << ": " << clips.size() << " sentences"
+                      << std::endl;
+            const uint32_t pause_ms = pool.trimmer().config().sentence_pause_ms;
+            bool submitted = clips.empty() ? pool.submit("", true, epoch) : true;
+            for (size_t i = 0; i < clips.size() && submitted; ++i) {
+                submitted = pool.submit_audio(clips[i], i + 1 == clips.size(), epoch, pause_ms);
+            }
+            if (!submitted) break;
+            continue;
+        }
+
+        bool is_last = false;
         if (text.find("END") != std::string::npos) {
-            first_msg = true;
+            is_last = true;
             size_t end_pos = text.find("END");
             text = text.substr(0, end_pos);
         }
 
-        int32_t audio_len = 0;
-        if (!text.empty()) {
-            std::cout << "[TTS infer] Inferring text: " << text << std::endl;
-            int16_t* wavData = model.infer(text, audio_len);
-            
-            if (wavData && audio_len > 0) {
-                auto audio_data = std::make_unique<int16_t[]>(audio_len);
-                memcpy(audio_data.get(), wavData, audio_len * sizeof(int16_t));
-                queue.push_audio(std::move(audio_data), audio_len, first_msg);
-                model.free_data(wavData);
-            }
-        } else {
-            auto empty_audio = std::make_unique<int16_t[]>(0);
-            queue.push_audio(std::move(empty_audio), 0, first_msg);
+        // 上一段回答结束或被打断后, 这是新回答的第一句
+        if (!in_answer || epoch != answer_epoch) planner.begin_answer();
+        in_answer = !is_last;
+        answer_epoch = epoch;
+
+        std::vector<std::string> chunks = planner.split(text);
+        if (chunks.empty()) chunks.emplace_back();  // 只有 END 时仍要交付回答结束
+        bool submitted = true;
+        for (size_t i = 0; i < chunks.size() && submitted; ++i) {
+            bool end_of_sentence = i + 1 == chunks.size();
+            uint32_t pause_ms = pool.trimmer().pause_after(chunks[i], end_of_sentence);
+            submitted = pool.submit(std::move(chunks[i]), is_last && end_of_sentence, epoch,
+                                    pause_ms);
         }
+        if (!submitted) break;
     }
+    pool.close();
 }
 
-void playback_worker(DoubleMessageQueue &queue, AudioPlayer &player) {
+// 交付线程: 合成结果按句子顺序交给播放线程, 先合成完的后面句子在重排缓冲区等待
+void release_worker(DoubleMessageQueue &queue, SynthesisPool &pool, ChunkPlanner &planner) {
+    SynthesisResult result;
+    while (pool.next(result)) {
+        if (result.infer_ms > 0) {
+            planner.observe(result.infer_ms,
+                            result.audio.length * 1000.0 / TTSModel::kSampleRate);
+        }
+        if (result.audio.empty() && !result.is_last) continue;
+
+        if (!queue.push_audio(std::move(result.audio), result.is_last, result.epoch,
+                              result.pause_ms)) {
+            std::cout << "[TTS infer] flushed, drop audio #" << result.seq << std::endl;
+        }
+        if (result.is_last) pool.print_stats();
+    }
+    queue.close_audio();
+}
+
+// 播放线程不直接操作 socket, 播放结束通知经 reactor 转交事件循环线程发送.
+// 一段回答内连续写入设备, 句间按 pause_ms 补停顿, 下一句未到时补静音, 回答结束才 drain
+void playback_worker(DoubleMessageQueue &queue, AudioSink &player,
+                     zmq_component::ZmqReactor &reactor, int status_id) {
+    // 每次最多写这么多再检查回答是否被打断
+    const size_t slice = player.period_frames() * 4;
+    const std::vector<int16_t> silence(slice, 0);
+    AudioMessage msg;
+    bool in_answer = false;
+    uint64_t answer_epoch = 0;
+
     while (true) {
-        auto msg = queue.pop_audio();
-        if (msg.data == nullptr) break;
-        
-        player.play(msg.data.get(), msg.length * sizeof(int16_t), 1.0f);
-        
+        RingPop result = RingPop::kOk;
+        if (in_answer) {
+            result = queue.pop_audio_for(msg, player.period_time());
+        } else if (!queue.pop_audio(msg)) {
+            result = RingPop::kStopped;
+        }
+        if (result == RingPop::kStopped) break;
+
+        if (result == RingPop::kTimeout) {
+            if (queue.epoch() != answer_epoch) {
+                player.drop();
+                in_answer = false;
+            } else {
+                player.keep_alive();
+            }
+            continue;
+        }
+
+        // 上一段回答被打断后直接来了新回答, 先丢掉设备里的残留
+        if (in_answer && msg.epoch != answer_epoch) player.drop();
+        in_answer = true;
+        answer_epoch = msg.epoch;
+
+        const PcmClip &audio = msg.audio;
+        for (size_t off = 0; off < audio.length && queue.epoch() == msg.epoch; off += slice) {
+            player.write(audio.samples.get() + off, std::min(slice, audio.length - off));
+        }
+        // 合成结果已去掉首尾静音, 句间停顿在这里补; 回答结束不补, 直接 drain
+        size_t pause =
+            msg.is_last ? 0 : static_cast<size_t>(msg.pause_ms) * player.sample_rate() / 1000;
+        for (size_t off = 0; off < pause && queue.epoch() == msg.epoch; off += slice) {
+            player.write(silence.data(), std::min(slice, pause - off));
+        }
+        // 写入设备后立即释放, 缓冲区交还合成器 (或只剩缓存持有)
+        msg.audio = PcmClip();
+        if (queue.epoch() != msg.epoch) {
+            player.drop();
+            in_answer = false;
+            continue;
+        }
+
         if (msg.is_last) {
-            status_server.send("[tts -> voice]play end success");
+            player.drain();
+            in_answer = false;
+            queue.answer_played();
+            reactor.post(status_id, "[tts -> voice]play end success");
+            queue.print_stats();
+            player.print_stats();
         }
     }
+    player.drain();
 }
 
 int main(int argc, char **argv) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <model_path>" << std::endl;
+        std::cerr << "Usage: " << argv[0]
+                  << " <model_path> [--workers N] [--omp-threads N] [--ahead N]"
+                     " [--pcm-cache-mb N] [--pcm-cache-dir DIR] [--audio-pack FILE]"
+                     " [--sink alsa|null|null-fast|wav:FILE] [--first-chunk N] [--max-chunk N]"
+                     " [--trim-db DB] [--pause-ms N]"
+                  << std::endl;
         return 1;
     }
 
+    SynthesisConfig synthesis_config;
+    std::string audio_pack_path;
+    std::string sink_spec = "alsa";
+    ChunkPolicy chunk_policy;
+    for (int i = 2; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for option: " << flag << std::endl;
+            return 1;
+        }
+        std::string arg = argv[i + 1];
+        int value = std::atoi(arg.c_str());
+        if (flag == "--workers") {
+            synthesis_config.workers = value;
+        } else if (flag == "--omp-threads") {
+            synthesis_config.omp_threads = value;
+        } else if (flag == "--ahead") {
+            synthesis_config.max_ahead = value;
+        } else if (flag == "--pcm-cache-mb") {
+            synthesis_config.cache.max_bytes = static_cast<size_t>(value) << 20;
+        } else if (flag == "--pcm-cache-dir") {
+            synthesis_config.cache.disk_dir = arg;
+        } else if (flag == "--audio-pack") {
+            audio_pack_path = arg;
+        } else if (flag == "--sink") {
+            sink_spec = arg;
+        } else if (flag == "--first-chunk") {
+            if (value < 0 || (value == 0 && arg != "0")) {
+                std::cerr << "Invalid --first-chunk: " << arg << std::endl;
+                return 1;
+            }
+            chunk_policy.first_chars = value;
+        } else if (flag == "--max-chunk") {
+            if (value <= 0) {
+                std::cerr << "Invalid --max-chunk: " << arg << std::endl;
+                return 1;
+            }
+            chunk_policy.max_chars = value;
+        } else if (flag == "--trim-db") {
+            synthesis_config.trim.enabled = value < 0;
+            synthesis_config.trim.threshold_db = static_cast<float>(value);
+        } else if (flag == "--pause-ms") {
+            synthesis_config.trim.sentence_pause_ms = value;
+            synthesis_config.trim.phrase_pause_ms = value / 2;
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // SIGINT/SIGTERM 由专门的线程 sigwait 接收后停止事件循环, 主线程再按 kDrain 收尾.
+    // 先屏蔽这两个信号, 之后创建的线程 (ZMQ、合成、播放) 都继承该屏蔽字
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     try {
-    
-        TTSModel model(argv[1]);
-        AudioPlayer player;
+
+        // 无声卡时用 null / wav 输出测吞吐和延迟
+        std::unique_ptr<AudioSink> player = AudioSink::create(sink_spec, TTSModel::kSampleRate);
+        if (!player) {
+            std::cerr << "Cannot open sink: " << sink_spec << std::endl;
+            return 1;
+        }
         DoubleMessageQueue queue;
+        std::shared_ptr<AudioPack> pack;
+        if (!audio_pack_path.empty()) {
+            pack = AudioPack::open(audio_pack_path);
+            if (pack && pack->sample_rate() != player->sample_rate()) {
+                std::cerr << "[audio pack] sample rate " << pack->sample_rate()
+                          << " does not match player, ignored" << std::endl;
+                pack.reset();
+            }
+        }
+        SynthesisPool pool(argv[1], synthesis_config,
+                           [&queue](uint64_t epoch) { return epoch != queue.epoch(); });
+        zmq_component::ZmqReactor reactor;
 
-        std::thread synthesis_thread(synthesis_worker, std::ref(queue), std::ref(model));
-        std::thread playback_thread(playback_worker, std::ref(queue), std::ref(player));
+        // 文本端口: 入队后回复, 与状态端口互不阻塞.
+        // 客户端合并后的多个短句以多帧消息到达, 拼成一句只做一次推理
+        // RAG 直接播报手册片段时发来 "<play chunk=ID hash=H>", 音频包里没有时回复 missing,
+        // RAG 改发原文
+        //
+        // 文本队列满时不丢弃也不阻塞事件循环: 暂不回复, 定时重试入队, 入队后再回复.
+        // 客户端是同步 REQ, 等回复期间不会发下一条; REP 回复前也不会收下一条, 自然形成背压
+        int text_id = -1;
+        int retry_timer = -1;
+        std::string pending_text, pending_reply;
+        bool pending_ends = false;
+        auto enqueue = [&](zmq::socket_t &socket, const std::string &text, bool ends_answer,
+                           const std::string &reply) {
+            if (queue.push_text(text)) {
+                if (ends_answer) queue.answer_received();
+                zmq_component::ZmqReactor::send(socket, reply);
+                return;
+            }
+            std::cout << "[llm -> tts] text queue full, waiting" << std::endl;
+            pending_text = text;
+            pending_reply = reply;
+            pending_ends = ends_answer;
+            retry_timer = reactor.addTimer(std::chrono::milliseconds(5), [&] {
+                if (!queue.push_text(pending_text)) return;
+                if (pending_ends) queue.answer_received();
+                reactor.cancelTimer(retry_timer);
+                zmq_component::ZmqReactor::send(reactor.socket(text_id), pending_reply);
+            });
+        };
 
-        while (true) {
-            if (first_msg) {
-                std::string req = status_server.receive();
-                std::cout << "[voice -> tts] received: " << req << std::endl;
+        text_id = reactor.addSocket(ZMQ_REP, "tcp://*:7777", [&](zmq::socket_t &socket) {
+            std::vector<std::string> frames = zmq_component::ZmqReactor::receiveMultipart(socket);
+
+            uint32_t chunk_id = 0, text_hash = 0;
+            if (frames.size() == 1 && AudioPack::parse_play(frames[0], chunk_id, text_hash)) {
+                bool ok = pack && !pack->chunk(chunk_id, text_hash).empty();
+                std::cout << "[rag -> tts] " << frames[0] << (ok ? "" : " missing") << std::endl;
+                if (ok) {
+                    enqueue(socket, frames[0], true, "play chunk ok");
+                } else {
+                    zmq_component::ZmqReactor::send(socket, "play chunk missing");
+                }
+                return;
+            }
+            // 是否还有已收到结束、尚未播放完的回答
+            if (frames.size() == 1 && frames[0] == "<status>") {
+                zmq_component::ZmqReactor::send(socket,
+                                                queue.answer_pending() ? "playing" : "idle");
+                return;
+            }
+
+            // LLM 回答被打断: 丢弃尚未合成和播放的内容, 被打断的回答不会再有 END
+            if (frames.size() == 1 && frames[0] == "<flush>") {
+                zmq_component::ZmqReactor::send(socket, "Echo: received");
+                queue.clear();
+                std::cout << "[llm -> tts] flush" << std::endl;
+                return;
             }
-            first_msg = false;
 
-            std::string text = server.receive();
-            server.send("Echo: received");
+            std::string text;
+            for (const auto &frame : frames) {
+                if (frame.empty()) continue;
+                if (!text.empty() && frame != "END") text += "，";
+                text += frame;
+            }
             std::cout << "[llm -> tts] received: " << text << std::endl;
 
-            if (!text.empty() && text.find("<think>") == std::string::npos) {
-                queue.push_text(text);
+            if (text.empty() || text.find("<think>") != std::string::npos) {
+                zmq_component::ZmqReactor::send(socket, "Echo: received");
+                return;
             }
-        }
+            enqueue(socket, text, text.find("END") != std::string::npos, "Echo: received");
+        });
+
+        // 状态端口: voice 发来的请求挂起, 直到播放线程投递播放结束通知再回复.
+        // 通知先于请求到达时暂存, 下一个请求到达后立即回复.
+        bool status_waiting = false;
+        std::deque<std::string> status_replies;
+        int status_id = reactor.addSocket(
+            ZMQ_REP, "tcp://*:6677", [&](zmq::socket_t &socket) {
+                std::string req = zmq_component::ZmqReactor::receive(socket);
+                std::cout << "[voice -> tts] received: " << req << std::endl;
 
-        // 清理
-        queue.stop();
-        synthesis_thread.join();
+                if (!status_replies.empty()) {
+                    zmq_component::ZmqReactor::send(socket, status_replies.front());
+                    status_replies.pop_front();
+                } else {
+                    status_waiting = true;
+                }
+            });
+        reactor.setPostHandler(status_id, [&](zmq::socket_t &socket, const std::string &reply) {
+            if (status_waiting) {
+                zmq_component::ZmqReactor::send(socket, reply);
+                status_waiting = false;
+            } else {
+                status_replies.push_back(reply);
+            }
+        });
+
+        ChunkPlanner planner(chunk_policy);
+        std::thread dispatch_thread(dispatch_worker, std::ref(queue), std::ref(pool), pack,
+                                    std::ref(planner));
+        std::thread release_thread(release_worker, std::ref(queue), std::ref(pool),
+                                   std::ref(planner));
+        std::thread playback_thread(playback_worker, std::ref(queue), std::ref(*player),
+                                    std::ref(reactor), status_id);
+
+        std::thread signal_thread([&reactor, &signals] {
+            int sig = 0;
+            sigwait(&signals, &sig);
+            std::cout << "[tts] signal " << sig << ", draining" << std::endl;
+            reactor.stop();
+        });
+
+        reactor.run();
+        signal_thread.join();
+
+        // 清理: 已收到的文本合成并播放完再退出. 收尾期间再收到信号按默认处理直接终止
+        pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+        queue.stop(DoubleMessageQueue::StopMode::kDrain);
+        dispatch_thread.join();
+        release_thread.join();
         playback_thread.join();
     } catch (const std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -99,4 +377,4 @@ int main(int argc, char **argv) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
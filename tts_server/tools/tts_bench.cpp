@@ -0,0 +1,399 @@
+// 合成性能基准: 把语料逐句按 tts_server 的方式切块 (一个线程按语料顺序用 ChunkPlanner 切块,
+// 按实测实时率放大块长), 多个线程 TTSModel 推理并去掉首尾静音,
+// 按不同的合成线程数和 OpenMP 线程数组合各跑一遍, 统计每句实时率、首块延迟、字/秒和峰值内存,
+// 并写出 JSON 报告, 用于发现 SummerTTS 集成上的性能回退.
+// 语料按手册播报的分句切句, 每行作为一段回答, 以 # 开头的行 (Markdown 标题) 跳过
+//
+// 用法: tts_bench <model_path> <corpus.txt> [--workers 1,2] [--omp-threads 1,2,4]
+//                 [--first-chunk N] [--max-chunk N] [--limit N] [--report FILE]
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ModelWeights.h"
+#include "SilenceTrimmer.h"
+#include "TTSModel.h"
+#include "TextProcessor.h"
+#include "Utf8Segmenter.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SentenceResult {
+    size_t chunks = 0;
+    double first_ms = 0;  // 第一块合成完的时刻, 即首包延迟
+    double total_ms = 0;
+    double audio_ms = 0;
+    int worker = -1;
+    bool ok = false;
+};
+
+struct SentenceJob {
+    size_t index = 0;
+    std::vector<std::string> chunks;
+};
+
+struct RunSummary {
+    int workers = 0;
+    int omp_threads = 0;
+    double wall_ms = 0;
+    long peak_rss_kb = 0;
+    std::vector<SentenceResult> sentences;
+};
+
+double elapsed_ms(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<int> parse_list(const std::string &arg)
+{
+    std::vector<int> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        values.push_back(std::atoi(item.c_str()));
+    return values;
+}
+
+// 最近秩百分位, values 会被排序
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(p / 100.0 * values.size() + 0.999999);
+    return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// 清零峰值 RSS 后每组配置单独统计; 不支持时读到的是进程启动以来的峰值
+void reset_peak_rss()
+{
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+}
+
+long peak_rss_kb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atol(line.c_str() + 6);
+    }
+    return 0;
+}
+
+// answer_start[i]: 第 i 句是一行 (一段回答) 的第一句
+std::vector<std::string> load_corpus(const std::string &path, size_t limit,
+                                     std::vector<bool> &answer_start)
+{
+    std::ifstream input(path);
+    std::vector<std::string> sentences;
+    const text_segmenter::SegmenterConfig config = text_segmenter::manual_speech_config();
+    std::string line;
+    while (std::getline(input, line) && sentences.size() < limit) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        bool first = true;
+        for (auto &sentence : text_segmenter::Utf8Segmenter::split(line, config)) {
+            if (sentences.size() < limit) {
+                sentences.push_back(std::move(sentence));
+                answer_start.push_back(first);
+                first = false;
+            }
+        }
+    }
+    return sentences;
+}
+
+RunSummary run(const std::shared_ptr<ModelWeights> &weights,
+               const std::vector<std::string> &corpus, const std::vector<bool> &answer_start,
+               const ChunkPolicy &policy, int workers, int omp_threads)
+{
+    RunSummary summary;
+    summary.workers = workers;
+    summary.omp_threads = omp_threads;
+    summary.sentences.resize(corpus.size());
+
+    std::vector<std::unique_ptr<TTSModel>> models;
+    for (int i = 0; i < workers; ++i)
+        models.push_back(std::make_unique<TTSModel>(weights));
+
+    // 与 tts_server 相同: 只有一个线程 (这里是调用线程) 按语料顺序切块, 像分发线程一样;
+    // 合成线程取走切好的块, 每块合成完按去掉静音后的时长回报实时率
+    ChunkPlanner planner(policy);
+    const SilenceTrimmer trimmer(SilenceTrimConfig(), TTSModel::kSampleRate);
+
+    // 每个线程先预热一次 (权重页面载入、OpenMP 线程创建), 全部就绪后同时开始计时
+    std::mutex mutex;
+    std::condition_variable cond;
+    int ready = 0;
+    bool started = false;
+    Clock::time_point start;
+
+    // 切好的句子, 最多领先合成线程 workers 句, 后面的句子按届时的实时率切块
+    std::deque<SentenceJob> jobs;
+    bool planned = false;
+    std::condition_variable job_cond, space_cond;
+
+    reset_peak_rss();
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            omp_set_num_threads(omp_threads);
+            TTSModel &model = *models[w];
+            model.synthesize(corpus.front());
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (++ready == workers) {
+                    start = Clock::now();
+                    started = true;
+                    cond.notify_all();
+                }
+                cond.wait(lock, [&] { return started; });
+            }
+
+            while (true) {
+                SentenceJob job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    job_cond.wait(lock, [&] { return !jobs.empty() || planned; });
+                    if (jobs.empty())
+                        break;
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                space_cond.notify_one();
+
+                SentenceResult &result = summary.sentences[job.index];
+                result.worker = w;
+                result.ok = true;
+
+                auto sentence_start = Clock::now();
+                for (const auto &chunk : job.chunks) {
+                    auto chunk_start = Clock::now();
+                    PcmClip clip = trimmer.trim(model.synthesize(chunk));
+                    if (clip.empty()) {
+                        result.ok = false;
+                        continue;
+                    }
+                    double audio_ms = clip.length * 1000.0 / TTSModel::kSampleRate;
+                    planner.observe(elapsed_ms(chunk_start), audio_ms);
+                    if (result.chunks++ == 0)
+                        result.first_ms = elapsed_ms(sentence_start);
+                    result.audio_ms += audio_ms;
+                }
+                result.total_ms = elapsed_ms(sentence_start);
+                result.ok = result.ok && result.chunks > 0;
+            }
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return started; });
+    }
+    for (size_t index = 0; index < corpus.size(); ++index) {
+        if (answer_start[index])
+            planner.begin_answer();
+        SentenceJob job{index, planner.split(corpus[index])};
+
+        std::unique_lock<std::mutex> lock(mutex);
+        space_cond.wait(lock, [&] { return jobs.size() < static_cast<size_t>(workers); });
+        jobs.push_back(std::move(job));
+        job_cond.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        planned = true;
+    }
+    job_cond.notify_all();
+
+    for (auto &thread : threads)
+        thread.join();
+
+    summary.wall_ms = elapsed_ms(start);
+    summary.peak_rss_kb = peak_rss_kb();
+    return summary;
+}
+
+std::string json_string(const std::string &s)
+{
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// 汇总一组配置, 同时打印到标准输出和写入报告
+void report(const RunSummary &summary, const std::vector<std::string> &corpus,
+            std::ostream &json)
+{
+    std::vector<double> rtf, latency, first;
+    double chars = 0, infer_ms = 0, audio_ms = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        const SentenceResult &r = summary.sentences[i];
+        if (!r.ok) {
+            ++failed;
+            continue;
+        }
+        chars += text_segmenter::utf8_length(corpus[i]);
+        infer_ms += r.total_ms;
+        audio_ms += r.audio_ms;
+        rtf.push_back(r.total_ms / r.audio_ms);
+        latency.push_back(r.total_ms);
+        first.push_back(r.first_ms);
+    }
+    double chars_per_s = summary.wall_ms > 0 ? chars * 1000.0 / summary.wall_ms : 0;
+
+    std::cout << "[bench] workers=" << summary.workers << " omp=" << summary.omp_threads
+              << " sentences=" << corpus.size() << " failed=" << failed
+              << " wall=" << summary.wall_ms << "ms chars/s=" << chars_per_s
+              << " rtf p50=" << percentile(rtf, 50) << " p99=" << percentile(rtf, 99)
+              << " latency p50=" << percentile(latency, 50) << "ms p99="
+              << percentile(latency, 99) << "ms first_audio p50=" << percentile(first, 50)
+              << "ms p99=" << percentile(first, 99) << "ms peak_rss="
+              << summary.peak_rss_kb / 1024 << "MB" << std::endl;
+
+    json << "    {\"workers\": " << summary.workers << ", \"omp_threads\": "
+         << summary.omp_threads << ", \"sentences\": " << corpus.size()
+         << ", \"failed\": " << failed << ", \"wall_ms\": " << summary.wall_ms
+         << ", \"chars_per_s\": " << chars_per_s
+         << ", \"rtf\": " << (audio_ms > 0 ? infer_ms / audio_ms : 0)
+         << ", \"rtf_p50\": " << percentile(rtf, 50) << ", \"rtf_p99\": " << percentile(rtf, 99)
+         << ", \"latency_p50_ms\": " << percentile(latency, 50)
+         << ", \"latency_p99_ms\": " << percentile(latency, 99)
+         << ", \"first_audio_p50_ms\": " << percentile(first, 50)
+         << ", \"first_audio_p99_ms\": " << percentile(first, 99)
+         << ", \"peak_rss_kb\": " << summary.peak_rss_kb << ",\n     \"per_sentence\": [";
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        const SentenceResult &r = summary.sentences[i];
+        json << (i ? ",\n" : "\n") << "      {\"text\": " << json_string(corpus[i])
+             << ", \"ok\": " << (r.ok ? "true" : "false") << ", \"worker\": " << r.worker
+             << ", \"chunks\": " << r.chunks << ", \"first_ms\": " << r.first_ms
+             << ", \"total_ms\": " << r.total_ms << ", \"audio_ms\": " << r.audio_ms
+             << ", \"rtf\": " << (r.audio_ms > 0 ? r.total_ms / r.audio_ms : 0) << "}";
+    }
+    json << "]}";
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <model_path> <corpus.txt> [--workers 1,2] [--omp-threads 1,2,4]"
+                     " [--first-chunk N] [--max-chunk N] [--limit N] [--report FILE]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<int> worker_counts{1};
+    std::vector<int> omp_counts{0};
+    ChunkPolicy chunk_policy;
+    size_t limit = static_cast<size_t>(-1);
+    std::string report_path = "tts_bench.json";
+    for (int i = 3; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for option: " << flag << std::endl;
+            return 1;
+        }
+        std::string arg = argv[i + 1];
+        int value = std::atoi(arg.c_str());
+        if (flag == "--workers") {
+            worker_counts = parse_list(arg);
+        } else if (flag == "--omp-threads") {
+            omp_counts = parse_list(arg);
+        } else if (flag == "--first-chunk") {
+            if (value < 0 || (value == 0 && arg != "0")) {
+                std::cerr << "Invalid --first-chunk: " << arg << std::endl;
+                return 1;
+            }
+            chunk_policy.first_chars = value;
+        } else if (flag == "--max-chunk") {
+            if (value <= 0) {
+                std::cerr << "Invalid --max-chunk: " << arg << std::endl;
+                return 1;
+            }
+            chunk_policy.max_chars = value;
+        } else if (flag == "--limit") {
+            limit = std::strtoul(arg.c_str(), nullptr, 10);
+        } else if (flag == "--report") {
+            report_path = arg;
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<bool> answer_start;
+    std::vector<std::string> corpus = load_corpus(argv[2], limit, answer_start);
+    if (corpus.empty()) {
+        std::cerr << "No sentences in " << argv[2] << std::endl;
+        return 1;
+    }
+    std::shared_ptr<ModelWeights> weights = ModelWeights::load(argv[1]);
+    if (!weights) {
+        std::cerr << "Cannot load TTS model: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::ofstream json(report_path);
+    if (!json) {
+        std::cerr << "Cannot write " << report_path << std::endl;
+        return 1;
+    }
+
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    json << "{\"model\": " << json_string(argv[1]) << ", \"corpus\": " << json_string(argv[2])
+         << ", \"cores\": " << cores << ", \"mapped\": " << (weights->mapped() ? "true" : "false")
+         << ",\n  \"runs\": [\n";
+    bool first_run = true;
+    for (int workers : worker_counts) {
+        for (int omp_threads : omp_counts) {
+            workers = std::max(1, workers);
+            // 0 与 SynthesisPool 一致: 按核数平分
+            int threads = omp_threads > 0 ? omp_threads : std::max(1, cores / workers);
+            RunSummary summary =
+                run(weights, corpus, answer_start, chunk_policy, workers, threads);
+            if (!first_run)
+                json << ",\n";
+            first_run = false;
+            report(summary, corpus, json);
+        }
+    }
+    json << "\n  ]\n}\n";
+    std::cout << "report -> " << report_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+// 离线预合成: 把手册每个片段去掉章节元数据后按 RAG 播报时的分句逐句合成, 写成音频包.
+// 输入为 vehicle_data_processor.py 生成的 vector_db/tts_chunks.tsv,
+// 每行 "片段ID<TAB>原文", 原文中的 \n \t \\ 已转义
+//
+// 用法: tts_pack <model_path> <chunks.tsv> <out.pack> [--workers N] [--omp-threads N]
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioPack.h"
+#include "SynthesisPool.h"
+#include "Utf8Segmenter.h"
+
+namespace {
+
+struct SentenceInfo {
+    uint32_t chunk_id;
+    uint32_t index;
+    uint32_t count;
+    uint32_t text_hash;
+};
+
+std::string unescape(const std::string &s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] != '\\' || i + 1 == s.size()) {
+            out += s[i];
+            continue;
+        }
+        char c = s[++i];
+        out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+    }
+    return out;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <model_path> <chunks.tsv> <out.pack> [--workers N] [--omp-threads N]"
+                  << std::endl;
+        return 1;
+    }
+
+    SynthesisConfig config;
+    config.cache.max_bytes = 0;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (flag == "--workers") {
+            config.workers = value;
+        } else if (flag == "--omp-threads") {
+            config.omp_threads = value;
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+    config.max_ahead = 4 * std::max(1, config.workers);
+
+    std::ifstream input(argv[2]);
+    if (!input) {
+        std::cerr << "Cannot open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    try {
+        SynthesisPool pool(argv[1], config, [](uint64_t) { return false; });
+
+        // 结果按提交顺序交付, 第 seq 个结果对应 sentences[seq]
+        std::vector<SentenceInfo> sentences;
+        std::mutex sentences_mutex;
+        AudioPackWriter writer;
+        size_t failed = 0;
+
+        std::thread collector([&] {
+            SynthesisResult result;
+            while (pool.next(result)) {
+                SentenceInfo info;
+                {
+                    std::lock_guard<std::mutex> lock(sentences_mutex);
+                    info = sentences[result.seq];
+                }
+                if (result.audio.empty()) {
+                    ++failed;
+                    continue;
+                }
+                writer.add(info.chunk_id, info.index, info.count, info.text_hash,
+                           result.audio.samples.get(), result.audio.length);
+            }
+        });
+
+        const text_segmenter::SegmenterConfig segmenter = text_segmenter::manual_speech_config();
+        std::string line;
+        size_t chunks = 0;
+        while (std::getline(input, line)) {
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos)
+                continue;
+            uint32_t chunk_id = static_cast<uint32_t>(std::stoul(line.substr(0, tab)));
+            // 与 RAG 播报相同, 只合成去掉章节元数据的正文, 哈希也按正文计算
+            std::string text = text_segmenter::manual_speech_text(unescape(line.substr(tab + 1)));
+            uint32_t hash = AudioPack::text_hash(text);
+
+            std::vector<std::string> segments =
+                text_segmenter::Utf8Segmenter::split(text, segmenter);
+            for (size_t i = 0; i < segments.size(); ++i) {
+                {
+                    std::lock_guard<std::mutex> lock(sentences_mutex);
+                    sentences.push_back(SentenceInfo{chunk_id, static_cast<uint32_t>(i),
+                                                     static_cast<uint32_t>(segments.size()),
+                                                     hash});
+                }
+                pool.submit(segments[i], false, 0);
+            }
+            ++chunks;
+        }
+        pool.close();
+        collector.join();
+
+        // 有句子合成失败的片段会缺句, AudioPack::chunk() 按缺句视为未命中, RAG 改发原文
+        if (!writer.write(argv[3], TTSModel::kSampleRate)) {
+            std::cerr << "Cannot write " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << "chunks=" << chunks << " sentences=" << writer.sentence_count()
+                  << " failed=" << failed << " -> " << argv[3] << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
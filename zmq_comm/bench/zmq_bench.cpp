@@ -0,0 +1,452 @@
+// zmq_bench: zmq_comm 单跳延迟与吞吐量基准测试
+//
+// 覆盖 REQ/REP、DEALER/ROUTER、PUSH/PULL 三种模式以及共享内存环形缓冲区(shm),
+// 传输方式 tcp/ipc/inproc, 消息大小 16 B ~ 1 MB, 拷贝发送与零拷贝发送.
+//   latency:    乒乓往返, 统计 p50/p99/p99.9 (微秒, 往返时间)
+//   throughput: 单向连续发送, 统计 msg/s 与 MB/s (REQ/REP 为锁步往返速率)
+//
+// 用法: ./zmq_bench [--quick] [--csv FILE] [--json FILE]
+//                   [--patterns reqrep,dealer,pushpull,shm] [--transports tcp,ipc,inproc]
+//                   [--sizes 16,1024,...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ShmClient.h"
+#include "ShmServer.h"
+
+using namespace zmq_component;
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::vector<std::string> patterns   = {"reqrep", "dealer", "pushpull", "shm"};
+    std::vector<std::string> transports = {"tcp", "ipc", "inproc"};
+    std::vector<size_t> sizes = {16, 256, 4096, 65536, 262144, 1048576};
+    size_t latency_budget_mb  = 64;   // 每组延迟测试最多往返的数据量
+    size_t stream_budget_mb   = 256;  // 每组吞吐测试最多发送的数据量
+    std::string csv_path;
+    std::string json_path;
+};
+
+struct BenchResult {
+    std::string pattern;
+    std::string transport;
+    std::string mode;    // copy / zerocopy
+    std::string metric;  // latency / throughput
+    size_t payload    = 0;
+    size_t iterations = 0;
+    double p50_us     = 0;
+    double p99_us     = 0;
+    double p999_us    = 0;
+    double msgs_per_s = 0;
+    double mb_per_s   = 0;
+};
+
+static BenchResult make_result(const std::string& pattern, const std::string& transport,
+                               bool zero_copy, size_t payload) {
+    BenchResult r;
+    r.pattern   = pattern;
+    r.transport = transport;
+    r.mode      = zero_copy ? "zerocopy" : "copy";
+    r.payload   = payload;
+    return r;
+}
+
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static BenchOptions parse_args(int argc, char** argv) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            opts.sizes             = {16, 4096, 1048576};
+            opts.latency_budget_mb = 8;
+            opts.stream_budget_mb  = 32;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            opts.csv_path = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            opts.json_path = argv[++i];
+        } else if (arg == "--patterns" && i + 1 < argc) {
+            opts.patterns = split_list(argv[++i]);
+        } else if (arg == "--transports" && i + 1 < argc) {
+            opts.transports = split_list(argv[++i]);
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            opts.sizes.clear();
+            for (const auto& s : split_list(argv[++i])) opts.sizes.push_back(std::stoul(s));
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--quick] [--csv FILE] [--json FILE] [--patterns LIST]"
+                         " [--transports LIST] [--sizes LIST]\n";
+            std::exit(arg == "--help" || arg == "-h" ? 0 : 1);
+        }
+    }
+    return opts;
+}
+
+// 每次测试使用新端点, 避免 tcp TIME_WAIT 和 ipc 残留文件干扰
+static std::string make_endpoint(const std::string& transport, const char* role) {
+    static int counter = 0;
+    int n              = counter++;
+    if (transport == "tcp") return "tcp://127.0.0.1:" + std::to_string(19000 + n);
+    if (transport == "ipc") return "ipc:///tmp/zmq_bench_" + std::string(role) + std::to_string(n);
+    return "inproc://zmq_bench_" + std::string(role) + std::to_string(n);
+}
+
+static void noop_free(void*, void*) {}
+
+// 拷贝模式由 zmq 分配并复制缓冲区; 零拷贝模式直接引用调用方缓冲区, 其生命周期长于 context
+static void send_payload(zmq::socket_t& socket, const std::string& buffer, bool zero_copy,
+                         zmq::send_flags flags = zmq::send_flags::none) {
+    if (zero_copy) {
+        zmq::message_t msg(const_cast<char*>(buffer.data()), buffer.size(), noop_free, nullptr);
+        (void)socket.send(msg, flags);
+    } else {
+        zmq::message_t msg(buffer.data(), buffer.size());
+        (void)socket.send(msg, flags);
+    }
+}
+
+static size_t iterations_for(size_t payload, size_t budget_mb, size_t lo, size_t hi) {
+    size_t n = (budget_mb << 20) / std::max<size_t>(payload, 1);
+    return std::min(hi, std::max(lo, n));
+}
+
+static void fill_latency(BenchResult& r, std::vector<double>& samples_us, double seconds) {
+    std::sort(samples_us.begin(), samples_us.end());
+    auto pct = [&samples_us](double p) {
+        size_t idx = static_cast<size_t>(p * samples_us.size());
+        return samples_us[std::min(idx, samples_us.size() - 1)];
+    };
+    r.metric     = "latency";
+    r.iterations = samples_us.size();
+    r.p50_us     = pct(0.50);
+    r.p99_us     = pct(0.99);
+    r.p999_us    = pct(0.999);
+    r.msgs_per_s = samples_us.size() / seconds;
+    r.mb_per_s   = r.msgs_per_s * r.payload / (1024.0 * 1024.0);
+}
+
+static void fill_throughput(BenchResult& r, size_t count, double seconds) {
+    r.metric     = "throughput";
+    r.iterations = count;
+    r.msgs_per_s = count / seconds;
+    r.mb_per_s   = r.msgs_per_s * r.payload / (1024.0 * 1024.0);
+}
+
+// 通用乒乓循环: ping() 发出一条消息并等待回显
+template <typename PingFn>
+static void measure_latency(BenchResult& r, size_t iterations, PingFn ping) {
+    size_t warmup = std::min<size_t>(iterations / 10, 100);
+    for (size_t i = 0; i < warmup; ++i) ping();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        auto t0 = Clock::now();
+        ping();
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    fill_latency(r, samples, seconds);
+}
+
+static BenchResult bench_reqrep(const std::string& transport, size_t payload, bool zero_copy,
+                                size_t iterations) {
+    BenchResult r = make_result("reqrep", transport, zero_copy, payload);
+    std::string buffer(payload, 'x');
+    std::string endpoint = make_endpoint(transport, "rep");
+    size_t total         = iterations + std::min<size_t>(iterations / 10, 100);
+
+    zmq::context_t context(1);
+    zmq::socket_t rep(context, ZMQ_REP);
+    rep.bind(endpoint);
+
+    std::thread echo([&] {
+        for (size_t i = 0; i < total; ++i) {
+            zmq::message_t msg;
+            (void)rep.recv(msg, zmq::recv_flags::none);
+            (void)rep.send(msg, zmq::send_flags::none);
+        }
+    });
+
+    zmq::socket_t req(context, ZMQ_REQ);
+    req.connect(endpoint);
+    measure_latency(r, iterations, [&] {
+        send_payload(req, buffer, zero_copy);
+        zmq::message_t reply;
+        (void)req.recv(reply, zmq::recv_flags::none);
+    });
+
+    echo.join();
+    return r;
+}
+
+static BenchResult bench_dealer_latency(const std::string& transport, size_t payload,
+                                        bool zero_copy, size_t iterations) {
+    BenchResult r = make_result("dealer", transport, zero_copy, payload);
+    std::string buffer(payload, 'x');
+    std::string endpoint = make_endpoint(transport, "router");
+    size_t total         = iterations + std::min<size_t>(iterations / 10, 100);
+
+    zmq::context_t context(1);
+    zmq::socket_t router(context, ZMQ_ROUTER);
+    router.bind(endpoint);
+
+    std::thread echo([&] {
+        for (size_t i = 0; i < total; ++i) {
+            zmq::message_t id, msg;
+            (void)router.recv(id, zmq::recv_flags::none);
+            (void)router.recv(msg, zmq::recv_flags::none);
+            (void)router.send(id, zmq::send_flags::sndmore);
+            (void)router.send(msg, zmq::send_flags::none);
+        }
+    });
+
+    zmq::socket_t dealer(context, ZMQ_DEALER);
+    dealer.connect(endpoint);
+    measure_latency(r, iterations, [&] {
+        send_payload(dealer, buffer, zero_copy);
+        zmq::message_t reply;
+        (void)dealer.recv(reply, zmq::recv_flags::none);
+    });
+
+    echo.join();
+    return r;
+}
+
+static BenchResult bench_pushpull_latency(const std::string& transport, size_t payload,
+                                          bool zero_copy, size_t iterations) {
+    BenchResult r = make_result("pushpull", transport, zero_copy, payload);
+    std::string buffer(payload, 'x');
+    std::string ping_endpoint = make_endpoint(transport, "ping");
+    std::string pong_endpoint = make_endpoint(transport, "pong");
+    size_t total              = iterations + std::min<size_t>(iterations / 10, 100);
+
+    // PUSH/PULL 单向, 乒乓需要两条通道
+    zmq::context_t context(1);
+    zmq::socket_t ping_pull(context, ZMQ_PULL);
+    ping_pull.bind(ping_endpoint);
+    zmq::socket_t pong_pull(context, ZMQ_PULL);
+    pong_pull.bind(pong_endpoint);
+
+    zmq::socket_t pong_push(context, ZMQ_PUSH);
+    pong_push.connect(pong_endpoint);
+    std::thread echo([&] {
+        for (size_t i = 0; i < total; ++i) {
+            zmq::message_t msg;
+            (void)ping_pull.recv(msg, zmq::recv_flags::none);
+            (void)pong_push.send(msg, zmq::send_flags::none);
+        }
+    });
+
+    zmq::socket_t ping_push(context, ZMQ_PUSH);
+    ping_push.connect(ping_endpoint);
+    measure_latency(r, iterations, [&] {
+        send_payload(ping_push, buffer, zero_copy);
+        zmq::message_t reply;
+        (void)pong_pull.recv(reply, zmq::recv_flags::none);
+    });
+
+    echo.join();
+    return r;
+}
+
+// 共享内存: copy 模式用 receive() 复制到 std::string, zerocopy 模式轮询 tryReceive(consumer)
+static BenchResult bench_shm_latency(size_t payload, bool zero_copy, size_t iterations) {
+    BenchResult r = make_result("shm", "shm", zero_copy, payload);
+    std::string buffer(payload, 'x');
+    size_t total = iterations + std::min<size_t>(iterations / 10, 100);
+    size_t ring  = std::max<size_t>(4 << 20, payload * 4);
+
+    ShmServer ping_server("zmq_bench_ping", ring);
+    ShmServer pong_server("zmq_bench_pong", ring);
+
+    std::thread echo([&] {
+        ShmClient pong_client("zmq_bench_pong");
+        for (size_t i = 0; i < total; ++i) {
+            if (zero_copy) {
+                auto forward = [&pong_client](const char* data, size_t length) {
+                    pong_client.send(data, length);
+                };
+                while (!ping_server.tryReceive(forward)) std::this_thread::yield();
+            } else {
+                pong_client.send(ping_server.receive());
+            }
+        }
+    });
+
+    ShmClient ping_client("zmq_bench_ping");
+    measure_latency(r, iterations, [&] {
+        ping_client.send(buffer.data(), buffer.size());
+        if (zero_copy) {
+            auto discard = [](const char*, size_t) {};
+            while (!pong_server.tryReceive(discard)) std::this_thread::yield();
+        } else {
+            (void)pong_server.receive();
+        }
+    });
+
+    echo.join();
+    return r;
+}
+
+static BenchResult bench_stream(const std::string& pattern, const std::string& transport,
+                                size_t payload, bool zero_copy, size_t count) {
+    BenchResult r = make_result(pattern, transport, zero_copy, payload);
+    std::string buffer(payload, 'x');
+    std::string endpoint = make_endpoint(transport, "stream");
+
+    bool dealer = pattern == "dealer";
+    zmq::context_t context(1);
+    zmq::socket_t sink(context, dealer ? ZMQ_ROUTER : ZMQ_PULL);
+    sink.bind(endpoint);
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        zmq::socket_t source(context, dealer ? ZMQ_DEALER : ZMQ_PUSH);
+        source.connect(endpoint);
+        for (size_t i = 0; i < count; ++i) send_payload(source, buffer, zero_copy);
+        source.close();
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        zmq::message_t msg;
+        if (dealer) (void)sink.recv(msg, zmq::recv_flags::none);  // routing id
+        (void)sink.recv(msg, zmq::recv_flags::none);
+    }
+    producer.join();
+
+    fill_throughput(r, count, std::chrono::duration<double>(Clock::now() - start).count());
+    return r;
+}
+
+static BenchResult bench_shm_stream(size_t payload, bool zero_copy, size_t count) {
+    BenchResult r = make_result("shm", "shm", zero_copy, payload);
+    std::string buffer(payload, 'x');
+    ShmServer server("zmq_bench_stream", std::max<size_t>(8 << 20, payload * 4));
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        ShmClient client("zmq_bench_stream");
+        for (size_t i = 0; i < count; ++i) client.send(buffer.data(), buffer.size());
+    });
+
+    size_t received = 0;
+    auto consume    = [&received](const char*, size_t length) { received += length; };
+    for (size_t i = 0; i < count; ++i) {
+        if (zero_copy) {
+            while (!server.tryReceive(consume)) std::this_thread::yield();
+        } else {
+            received += server.receive().size();
+        }
+    }
+    producer.join();
+
+    fill_throughput(r, count, std::chrono::duration<double>(Clock::now() - start).count());
+    return r;
+}
+
+static void print_result(const BenchResult& r) {
+    printf("%-9s %-7s %-9s %-11s %8zu %8zu %10.1f %10.1f %10.1f %12.0f %10.1f\n",
+           r.pattern.c_str(), r.transport.c_str(), r.mode.c_str(), r.metric.c_str(), r.payload,
+           r.iterations, r.p50_us, r.p99_us, r.p999_us, r.msgs_per_s, r.mb_per_s);
+    fflush(stdout);
+}
+
+static void write_csv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << "pattern,transport,mode,metric,payload_bytes,iterations,p50_us,p99_us,p999_us,"
+           "msgs_per_s,mb_per_s\n";
+    for (const auto& r : results) {
+        out << r.pattern << ',' << r.transport << ',' << r.mode << ',' << r.metric << ','
+            << r.payload << ',' << r.iterations << ',' << r.p50_us << ',' << r.p99_us << ','
+            << r.p999_us << ',' << r.msgs_per_s << ',' << r.mb_per_s << '\n';
+    }
+}
+
+static void write_json(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"pattern\": \"" << r.pattern << "\", \"transport\": \"" << r.transport
+            << "\", \"mode\": \"" << r.mode << "\", \"metric\": \"" << r.metric
+            << "\", \"payload_bytes\": " << r.payload << ", \"iterations\": " << r.iterations
+            << ", \"p50_us\": " << r.p50_us << ", \"p99_us\": " << r.p99_us
+            << ", \"p999_us\": " << r.p999_us << ", \"msgs_per_s\": " << r.msgs_per_s
+            << ", \"mb_per_s\": " << r.mb_per_s << "}" << (i + 1 < results.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts = parse_args(argc, argv);
+    std::vector<BenchResult> results;
+
+    printf("%-9s %-7s %-9s %-11s %8s %8s %10s %10s %10s %12s %10s\n", "pattern", "trans", "mode",
+           "metric", "payload", "iters", "p50_us", "p99_us", "p999_us", "msg/s", "MB/s");
+
+    auto record = [&results](BenchResult r) {
+        print_result(r);
+        results.push_back(std::move(r));
+    };
+
+    try {
+        for (size_t payload : opts.sizes) {
+            size_t lat_iters = iterations_for(payload, opts.latency_budget_mb, 200, 20000);
+            size_t stream_n  = iterations_for(payload, opts.stream_budget_mb, 1000, 1000000);
+
+            for (bool zero_copy : {false, true}) {
+                for (const auto& pattern : opts.patterns) {
+                    if (pattern == "shm") {
+                        record(bench_shm_latency(payload, zero_copy, lat_iters));
+                        record(bench_shm_stream(payload, zero_copy, stream_n));
+                        continue;
+                    }
+                    for (const auto& transport : opts.transports) {
+                        if (pattern == "reqrep") {
+                            BenchResult r = bench_reqrep(transport, payload, zero_copy, lat_iters);
+                            record(r);
+                            // REQ/REP 只能锁步收发, 吞吐量即往返速率
+                            r.metric   = "throughput";
+                            r.p50_us   = r.p99_us = r.p999_us = 0;
+                            record(r);
+                        } else if (pattern == "dealer") {
+                            record(bench_dealer_latency(transport, payload, zero_copy, lat_iters));
+                            record(bench_stream(pattern, transport, payload, zero_copy, stream_n));
+                        } else if (pattern == "pushpull") {
+                            record(
+                                bench_pushpull_latency(transport, payload, zero_copy, lat_iters));
+                            record(bench_stream(pattern, transport, payload, zero_copy, stream_n));
+                        }
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!opts.csv_path.empty()) write_csv(opts.csv_path, results);
+    if (!opts.json_path.empty()) write_json(opts.json_path, results);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace zmq_component {
+
+struct CoalescerConfig {
+    size_t max_chars = 48;   // 单批最多字符数(按 UTF-8 码点计), 单个片段超长时独占一批
+    int max_delay_ms = 400;  // 批次中最早片段最多等待的时间, 到期由调用方调用 poll() 发出
+    bool flush_first = true;  // 每轮回答的第一个片段立即发送, 降低首音延迟
+};
+
+// 把逐句到达的短文本片段合并成较大的批次, 减少 TTS 往返和推理次数.
+// 批次以片段列表交给 sink, 由调用方作为一条多帧消息发送. 非线程安全.
+// 生产者停顿时 push() 不会被调用, 调用方等待下一个片段最多到 deadline(), 超时后调用 poll()
+class MessageCoalescer {
+   public:
+    using Sink = std::function<void(const std::vector<std::string>&)>;
+
+    explicit MessageCoalescer(Sink sink, CoalescerConfig config = CoalescerConfig());
+
+    void push(const std::string& fragment);
+    // 发送所有暂存片段, 回答结束时调用
+    void flush();
+    // 开始新一轮回答, 下一个片段重新按首片段处理
+    void reset();
+
+    // 暂存片段最迟的发送时刻, 没有暂存片段时返回 false
+    bool deadline(std::chrono::steady_clock::time_point& at) const;
+    // 暂存片段已到期时发送
+    void poll();
+
+    size_t pendingChars() const { return pending_chars_; }
+
+    static size_t countChars(const std::string& text);
+
+   private:
+    Sink sink_;
+    CoalescerConfig config_;
+
+    std::vector<std::string> pending_;
+    size_t pending_chars_ = 0;
+    std::chrono::steady_clock::time_point pending_since_;
+    bool first_sent_ = false;
+};
+
+}  // namespace zmq_component
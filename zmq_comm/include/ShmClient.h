@@ -0,0 +1,24 @@
+#pragma once
+#include "ShmRing.h"
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+// 共享内存发送端: 连接 ShmServer 创建的环形缓冲区, 只在接收端睡眠时才发送一次 ZMQ 唤醒通知
+class ShmClient : public ZmqInterface {
+   public:
+    explicit ShmClient(const std::string& name = "rag_shm");
+
+    // 缓冲区满时等待接收端消费, 超过 setTimeout() 设置的时间抛出异常
+    void send(const std::string& message);
+    void send(const void* data, size_t length);
+    // 非阻塞, 缓冲区满时返回 false
+    bool trySend(const void* data, size_t length);
+
+   private:
+    void notify();
+
+    ShmRing ring_;
+};
+
+}  // namespace zmq_component
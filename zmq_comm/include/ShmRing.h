@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace zmq_component {
+
+// POSIX 共享内存中的单生产者/单消费者无锁环形缓冲区.
+// 消息按 [8 字节头 | 数据 | 8 字节对齐填充] 连续存放, 读写只各自推进一个位置计数器,
+// 数据只在用户态复制一次, 不经过内核.
+class ShmRing {
+   public:
+    // create=true 时创建(覆盖同名残留段)并初始化, 否则打开已存在的段. capacity 向上取整为 2 的幂
+    ShmRing(const std::string& name, size_t capacity, bool create);
+    ~ShmRing();
+
+    ShmRing(const ShmRing&)            = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // 生产者侧, 空间不足时返回 false
+    bool tryWrite(const void* data, size_t length);
+
+    // 消费者侧, 无数据时返回 false. 回调版本直接读取共享内存, 回调返回后该区域即被释放
+    bool tryRead(std::string& message);
+    bool tryRead(const std::function<void(const char*, size_t)>& consumer);
+
+    bool empty() const;
+    size_t capacity() const { return capacity_; }
+    size_t maxMessageSize() const { return capacity_ / 2 - kRecordHeaderSize; }
+
+    // 消费者睡眠前置位, 生产者写入后取走该标记以决定是否需要唤醒
+    void setReaderWaiting(bool waiting);
+    bool takeReaderWaiting();
+
+   private:
+    struct Header;
+
+    static constexpr size_t kRecordHeaderSize = 8;
+    static constexpr uint32_t kWrapMarker     = 0xFFFFFFFFu;
+
+    static size_t recordSize(size_t length) {
+        return (kRecordHeaderSize + length + 7) & ~static_cast<size_t>(7);
+    }
+
+    std::string name_;
+    bool owner_      = false;
+    size_t capacity_ = 0;
+    size_t map_size_ = 0;
+    Header* header_  = nullptr;
+    char* data_      = nullptr;
+};
+
+}  // namespace zmq_component
@@ -0,0 +1,25 @@
+#pragma once
+#include "ShmRing.h"
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+// 共享内存接收端: 创建环形缓冲区, 数据走共享内存, ZMQ PULL socket 只用于空闲时的唤醒通知
+class ShmServer : public ZmqInterface {
+   public:
+    explicit ShmServer(const std::string& name = "rag_shm", size_t capacity = 4 << 20);
+
+    // 阻塞直到收到消息, 超过 setTimeout() 设置的时间抛出异常
+    std::string receive();
+    // 非阻塞, 无消息时返回 false
+    bool tryReceive(std::string& message);
+    // 零拷贝读取: 回调直接访问共享内存中的数据
+    bool tryReceive(const std::function<void(const char*, size_t)>& consumer);
+
+    static std::string notifyAddress(const std::string& name);
+
+   private:
+    ShmRing ring_;
+};
+
+}  // namespace zmq_component
@@ -12,6 +12,10 @@ class ZmqClient : public ZmqInterface {
     std::string receiveResponse();
 
     std::string request(const std::string& message);
+
+    // 多个片段作为一条多帧消息发送
+    void sendRequest(const std::vector<std::string>& frames);
+    std::string request(const std::vector<std::string>& frames);
 };
 
 }  // namespace zmq_component
@@ -3,6 +3,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <zmq.hpp>
 
 namespace zmq_component {
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+// 单线程事件循环: 用 zmq::poll 同时监听多个 socket 和定时器, 在 run() 所在线程中分发处理函数.
+// 其他线程不能直接操作这些 socket, 只能通过 post() 经 inproc 队列把消息交给事件循环线程发送.
+class ZmqReactor {
+   public:
+    using SocketHandler = std::function<void(zmq::socket_t&)>;
+    using PostHandler   = std::function<void(zmq::socket_t&, const std::string&)>;
+    using TimerHandler  = std::function<void()>;
+
+    ZmqReactor();
+    ~ZmqReactor();
+
+    ZmqReactor(const ZmqReactor&)            = delete;
+    ZmqReactor& operator=(const ZmqReactor&) = delete;
+
+    // 创建 socket 并注册可读回调, REP/ROUTER/PULL/PUB 绑定地址, 其余类型连接地址. 返回 socket id
+    int addSocket(int socket_type, const std::string& address, SocketHandler on_readable);
+
+    // 自定义 post() 到该 socket 的消息如何处理 (默认直接发送), 回调在事件循环线程中执行
+    void setPostHandler(int socket_id, PostHandler handler);
+
+    int addTimer(std::chrono::milliseconds interval, TimerHandler handler, bool repeat = true);
+    void cancelTimer(int timer_id);
+
+    zmq::socket_t& socket(int socket_id);
+
+    // 线程安全: 把消息排队给事件循环线程, 由其在 socket_id 对应的 socket 上发送
+    void post(int socket_id, const std::string& message);
+
+    void run();
+    // 线程安全: 通知事件循环在当前一轮分发完成后退出
+    void stop();
+
+    static std::string receive(zmq::socket_t& socket);
+    static std::vector<std::string> receiveMultipart(zmq::socket_t& socket);
+    static void send(zmq::socket_t& socket, const std::string& message);
+
+   private:
+    struct SocketEntry {
+        std::unique_ptr<zmq::socket_t> socket;
+        SocketHandler on_readable;
+        PostHandler on_post;
+    };
+
+    struct TimerEntry {
+        std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point deadline;
+        TimerHandler handler;
+        bool repeat;
+    };
+
+    void drainPosted();
+    void fireTimers();
+    long nextTimeoutMs() const;
+
+    static constexpr int kStopId = -1;
+
+    std::unique_ptr<zmq::context_t> context_;
+    std::string inbox_address_;
+    std::unique_ptr<zmq::socket_t> inbox_;   // PULL, 事件循环线程独占
+    std::unique_ptr<zmq::socket_t> outbox_;  // PUSH, 由 post_mutex_ 保护
+    std::mutex post_mutex_;
+
+    std::map<int, SocketEntry> sockets_;
+    std::map<int, TimerEntry> timers_;
+    int next_socket_id_ = 0;
+    int next_timer_id_  = 0;
+
+    std::atomic<bool> running_{false};
+};
+
+}  // namespace zmq_component
@@ -7,6 +7,8 @@ class ZmqServer : public ZmqInterface {
    public:
     explicit ZmqServer(const std::string &address = "tcp://*:6666");
     std::string receive();
+    // 接收一条多帧消息的全部帧
+    std::vector<std::string> receiveMultipart();
     void send(const std::string &response);
 };
 
@@ -0,0 +1,70 @@
+#include "MessageCoalescer.h"
+
+namespace zmq_component {
+
+MessageCoalescer::MessageCoalescer(Sink sink, CoalescerConfig config)
+    : sink_(std::move(sink)), config_(config) {}
+
+size_t MessageCoalescer::countChars(const std::string& text) {
+    size_t count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++count;
+    }
+    return count;
+}
+
+void MessageCoalescer::push(const std::string& fragment) {
+    if (fragment.empty()) return;
+
+    if (config_.flush_first && !first_sent_) {
+        first_sent_ = true;
+        sink_({fragment});
+        return;
+    }
+
+    size_t chars = countChars(fragment);
+    if (!pending_.empty() && pending_chars_ + chars > config_.max_chars) {
+        flush();
+    }
+
+    if (pending_.empty()) {
+        pending_since_ = std::chrono::steady_clock::now();
+    }
+    pending_.push_back(fragment);
+    pending_chars_ += chars;
+
+    auto waited = std::chrono::steady_clock::now() - pending_since_;
+    if (pending_chars_ >= config_.max_chars ||
+        waited >= std::chrono::milliseconds(config_.max_delay_ms)) {
+        flush();
+    }
+}
+
+void MessageCoalescer::flush() {
+    if (pending_.empty()) return;
+
+    std::vector<std::string> batch;
+    batch.swap(pending_);
+    pending_chars_ = 0;
+    first_sent_    = true;
+    sink_(batch);
+}
+
+bool MessageCoalescer::deadline(std::chrono::steady_clock::time_point& at) const {
+    if (pending_.empty()) return false;
+    at = pending_since_ + std::chrono::milliseconds(config_.max_delay_ms);
+    return true;
+}
+
+void MessageCoalescer::poll() {
+    std::chrono::steady_clock::time_point at;
+    if (deadline(at) && std::chrono::steady_clock::now() >= at) flush();
+}
+
+void MessageCoalescer::reset() {
+    pending_.clear();
+    pending_chars_ = 0;
+    first_sent_    = false;
+}
+
+}  // namespace zmq_component
@@ -0,0 +1,53 @@
+#include "ShmClient.h"
+
+#include <chrono>
+#include <thread>
+
+#include "ShmServer.h"
+
+namespace zmq_component {
+
+namespace {
+constexpr int kSpinTries = 64;
+}
+
+ShmClient::ShmClient(const std::string& name) : ring_(name, 0, false) {
+    setupSocket(ZMQ_PUSH, ShmServer::notifyAddress(name));
+}
+
+bool ShmClient::trySend(const void* data, size_t length) {
+    if (!ring_.tryWrite(data, length)) {
+        return false;
+    }
+    notify();
+    return true;
+}
+
+void ShmClient::send(const std::string& message) { send(message.data(), message.size()); }
+
+void ShmClient::send(const void* data, size_t length) {
+    using clock   = std::chrono::steady_clock;
+    auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms_);
+
+    // 缓冲区满说明接收端落后, 先让出 CPU 再退避睡眠, 不占用通知通道
+    for (int tries = 0; !trySend(data, length); ++tries) {
+        if (timeout_ms_ >= 0 && clock::now() >= deadline) {
+            throw ZmqCommunicationError("Send timeout");
+        }
+        if (tries < kSpinTries) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void ShmClient::notify() {
+    if (!ring_.takeReaderWaiting()) {
+        return;
+    }
+    zmq::message_t wakeup(0);
+    (void)socket_->send(wakeup, zmq::send_flags::dontwait);
+}
+
+}  // namespace zmq_component
@@ -0,0 +1,184 @@
+#include "ShmRing.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory ring needs lock-free 64-bit atomics");
+
+namespace {
+
+constexpr uint32_t kShmMagic = 0x52414753;  // "RAGS"
+constexpr size_t kCacheLine  = 64;
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1024;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+std::string shmPath(const std::string& name) { return name[0] == '/' ? name : "/" + name; }
+
+}  // namespace
+
+// 读写计数器各占一条缓存行, 避免生产者与消费者伪共享
+struct ShmRing::Header {
+    std::atomic<uint32_t> magic;
+    uint64_t capacity;
+    alignas(kCacheLine) std::atomic<uint64_t> write_pos;
+    alignas(kCacheLine) std::atomic<uint64_t> read_pos;
+    alignas(kCacheLine) std::atomic<uint32_t> reader_waiting;
+};
+
+ShmRing::ShmRing(const std::string& name, size_t capacity, bool create)
+    : name_(shmPath(name)), owner_(create) {
+    int fd = -1;
+    if (create) {
+        shm_unlink(name_.c_str());
+        fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    } else {
+        fd = shm_open(name_.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        throw ZmqCommunicationError("shm_open " + name_ + ": " + strerror(errno));
+    }
+
+    size_t header_size = (sizeof(Header) + kCacheLine - 1) & ~(kCacheLine - 1);
+    if (create) {
+        capacity_ = roundUpPowerOfTwo(capacity);
+        map_size_ = header_size + capacity_;
+        if (ftruncate(fd, static_cast<off_t>(map_size_)) != 0) {
+            close(fd);
+            shm_unlink(name_.c_str());
+            throw ZmqCommunicationError("ftruncate " + name_ + ": " + strerror(errno));
+        }
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= header_size) {
+            close(fd);
+            throw ZmqCommunicationError("shm segment not ready: " + name_);
+        }
+        map_size_ = static_cast<size_t>(st.st_size);
+    }
+
+    void* addr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        if (create) shm_unlink(name_.c_str());
+        throw ZmqCommunicationError("mmap " + name_ + ": " + strerror(errno));
+    }
+
+    header_ = static_cast<Header*>(addr);
+    data_   = static_cast<char*>(addr) + header_size;
+
+    if (create) {
+        new (header_) Header();
+        header_->capacity = capacity_;
+        header_->write_pos.store(0, std::memory_order_relaxed);
+        header_->read_pos.store(0, std::memory_order_relaxed);
+        header_->reader_waiting.store(0, std::memory_order_relaxed);
+        header_->magic.store(kShmMagic, std::memory_order_release);
+    } else {
+        if (header_->magic.load(std::memory_order_acquire) != kShmMagic) {
+            munmap(addr, map_size_);
+            header_ = nullptr;
+            throw ZmqCommunicationError("shm segment not initialized: " + name_);
+        }
+        capacity_ = static_cast<size_t>(header_->capacity);
+    }
+}
+
+ShmRing::~ShmRing() {
+    if (header_) munmap(header_, map_size_);
+    if (owner_) shm_unlink(name_.c_str());
+}
+
+bool ShmRing::tryWrite(const void* data, size_t length) {
+    if (length > maxMessageSize()) {
+        throw ZmqCommunicationError("Message too large for shm ring");
+    }
+
+    const size_t mask  = capacity_ - 1;
+    const size_t need  = recordSize(length);
+    uint64_t write_pos = header_->write_pos.load(std::memory_order_relaxed);
+    uint64_t read_pos  = header_->read_pos.load(std::memory_order_acquire);
+
+    size_t index     = static_cast<size_t>(write_pos) & mask;
+    size_t tail_room = capacity_ - index;
+    size_t padding   = tail_room < need ? tail_room : 0;
+
+    if (write_pos + padding + need - read_pos > capacity_) {
+        return false;
+    }
+
+    if (padding) {
+        // 尾部剩余空间放不下整条记录, 写入回绕标记后从头开始
+        memcpy(data_ + index, &kWrapMarker, sizeof(kWrapMarker));
+        write_pos += padding;
+        index = 0;
+    }
+
+    uint32_t record_length = static_cast<uint32_t>(length);
+    memcpy(data_ + index, &record_length, sizeof(record_length));
+    memcpy(data_ + index + kRecordHeaderSize, data, length);
+
+    header_->write_pos.store(write_pos + need, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::tryRead(const std::function<void(const char*, size_t)>& consumer) {
+    const size_t mask  = capacity_ - 1;
+    uint64_t read_pos  = header_->read_pos.load(std::memory_order_relaxed);
+    uint64_t write_pos = header_->write_pos.load(std::memory_order_acquire);
+    if (read_pos == write_pos) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>(read_pos) & mask;
+    uint32_t record_length;
+    memcpy(&record_length, data_ + index, sizeof(record_length));
+    if (record_length == kWrapMarker) {
+        read_pos += capacity_ - index;
+        index = 0;
+        memcpy(&record_length, data_, sizeof(record_length));
+    }
+
+    consumer(data_ + index + kRecordHeaderSize, record_length);
+
+    header_->read_pos.store(read_pos + recordSize(record_length), std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::tryRead(std::string& message) {
+    return tryRead([&message](const char* data, size_t length) { message.assign(data, length); });
+}
+
+bool ShmRing::empty() const {
+    return header_->read_pos.load(std::memory_order_acquire) ==
+           header_->write_pos.load(std::memory_order_acquire);
+}
+
+void ShmRing::setReaderWaiting(bool waiting) {
+    header_->reader_waiting.store(waiting ? 1 : 0, std::memory_order_seq_cst);
+    // 与 takeReaderWaiting() 中的栅栏配对: 置位后再检查数据, 保证不会错过唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool ShmRing::takeReaderWaiting() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->reader_waiting.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    return header_->reader_waiting.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+}  // namespace zmq_component
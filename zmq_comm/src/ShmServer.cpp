@@ -0,0 +1,72 @@
+#include "ShmServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace zmq_component {
+
+namespace {
+constexpr int kSpinTries = 64;
+// 兜底的最长睡眠时间, 发送端重启等情况下即使丢失唤醒通知也能继续取数据
+constexpr long kMaxSleepMs = 100;
+}
+
+ShmServer::ShmServer(const std::string& name, size_t capacity) : ring_(name, capacity, true) {
+    setupSocket(ZMQ_PULL, notifyAddress(name));
+}
+
+std::string ShmServer::notifyAddress(const std::string& name) {
+    return "ipc:///tmp/" + name + ".shm_notify";
+}
+
+bool ShmServer::tryReceive(std::string& message) { return ring_.tryRead(message); }
+
+bool ShmServer::tryReceive(const std::function<void(const char*, size_t)>& consumer) {
+    return ring_.tryRead(consumer);
+}
+
+std::string ShmServer::receive() {
+    using clock   = std::chrono::steady_clock;
+    auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms_);
+
+    std::string message;
+    while (true) {
+        // 先短暂自旋, 连续数据流时无需进入 poll
+        for (int i = 0; i < kSpinTries; ++i) {
+            if (ring_.tryRead(message)) return message;
+            std::this_thread::yield();
+        }
+
+        ring_.setReaderWaiting(true);
+        if (ring_.tryRead(message)) {
+            ring_.setReaderWaiting(false);
+            return message;
+        }
+
+        long wait_ms = kMaxSleepMs;
+        if (timeout_ms_ >= 0) {
+            auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now());
+            if (remaining.count() <= 0) {
+                ring_.setReaderWaiting(false);
+                throw ZmqCommunicationError("Receive timeout");
+            }
+            wait_ms = std::min(wait_ms, static_cast<long>(remaining.count()));
+        }
+
+        try {
+            zmq::pollitem_t item{static_cast<void*>(*socket_), 0, ZMQ_POLLIN, 0};
+            zmq::poll(&item, 1, std::chrono::milliseconds(wait_ms));
+
+            zmq::message_t wakeup;
+            while (socket_->recv(wakeup, zmq::recv_flags::dontwait)) {
+            }
+        } catch (const zmq::error_t& e) {
+            if (e.num() != EINTR) throw ZmqCommunicationError(e.what());
+        }
+        ring_.setReaderWaiting(false);
+    }
+}
+
+}  // namespace zmq_component
@@ -14,6 +14,19 @@ void ZmqClient::sendRequest(const std::string& message) {
     }
 }
 
+void ZmqClient::sendRequest(const std::vector<std::string>& frames) {
+    for (size_t i = 0; i < frames.size(); ++i) {
+        zmq::message_t request(frames[i].size());
+        memcpy(request.data(), frames[i].c_str(), frames[i].size());
+
+        auto flags  = i + 1 < frames.size() ? zmq::send_flags::sndmore : zmq::send_flags::none;
+        auto result = socket_->send(request, flags);
+        if (!result) {
+            throw ZmqCommunicationError("Send timeout");
+        }
+    }
+}
+
 std::string ZmqClient::receiveResponse() {
     zmq::message_t reply;
 
@@ -30,4 +43,9 @@ std::string ZmqClient::request(const std::string& message) {
     return receiveResponse();
 }
 
+std::string ZmqClient::request(const std::vector<std::string>& frames) {
+    sendRequest(frames);
+    return receiveResponse();
+}
+
 }  // namespace zmq_component
@@ -13,7 +13,8 @@ void ZmqInterface::setupSocket(int socket_type, const std::string& address) {
         socket_->set(zmq::sockopt::rcvtimeo, timeout_ms_);
         socket_->set(zmq::sockopt::sndtimeo, timeout_ms_);
 
-        (socket_type == ZMQ_REP) ? socket_->bind(address) : socket_->connect(address);
+        bool binds = socket_type == ZMQ_REP || socket_type == ZMQ_PULL;
+        binds ? socket_->bind(address) : socket_->connect(address);
     } catch (const zmq::error_t& e) {
         throw ZmqCommunicationError(e.what());
     }
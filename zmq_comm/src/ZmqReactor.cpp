@@ -0,0 +1,237 @@
+#include "ZmqReactor.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace zmq_component {
+
+ZmqReactor::ZmqReactor() {
+    std::ostringstream address;
+    address << "inproc://zmq_reactor_" << static_cast<const void*>(this);
+    inbox_address_ = address.str();
+
+    try {
+        context_ = std::make_unique<zmq::context_t>(1);
+        inbox_   = std::make_unique<zmq::socket_t>(*context_, ZMQ_PULL);
+        inbox_->bind(inbox_address_);
+        outbox_ = std::make_unique<zmq::socket_t>(*context_, ZMQ_PUSH);
+        outbox_->connect(inbox_address_);
+    } catch (const zmq::error_t& e) {
+        throw ZmqCommunicationError(e.what());
+    }
+}
+
+ZmqReactor::~ZmqReactor() {
+    for (auto& entry : sockets_) {
+        entry.second.socket->close();
+    }
+    if (outbox_) outbox_->close();
+    if (inbox_) inbox_->close();
+    if (context_) context_->close();
+}
+
+int ZmqReactor::addSocket(int socket_type, const std::string& address, SocketHandler on_readable) {
+    SocketEntry entry;
+    try {
+        entry.socket = std::make_unique<zmq::socket_t>(*context_, socket_type);
+        entry.socket->set(zmq::sockopt::linger, 0);
+
+        bool binds = socket_type == ZMQ_REP || socket_type == ZMQ_ROUTER ||
+                     socket_type == ZMQ_PULL || socket_type == ZMQ_PUB;
+        binds ? entry.socket->bind(address) : entry.socket->connect(address);
+    } catch (const zmq::error_t& e) {
+        throw ZmqCommunicationError(e.what());
+    }
+    entry.on_readable = std::move(on_readable);
+
+    int id = next_socket_id_++;
+    sockets_.emplace(id, std::move(entry));
+    return id;
+}
+
+void ZmqReactor::setPostHandler(int socket_id, PostHandler handler) {
+    auto it = sockets_.find(socket_id);
+    if (it == sockets_.end()) {
+        throw ZmqCommunicationError("Unknown socket id");
+    }
+    it->second.on_post = std::move(handler);
+}
+
+int ZmqReactor::addTimer(std::chrono::milliseconds interval, TimerHandler handler, bool repeat) {
+    int id = next_timer_id_++;
+    timers_[id] = {interval, std::chrono::steady_clock::now() + interval, std::move(handler),
+                   repeat};
+    return id;
+}
+
+void ZmqReactor::cancelTimer(int timer_id) { timers_.erase(timer_id); }
+
+zmq::socket_t& ZmqReactor::socket(int socket_id) {
+    auto it = sockets_.find(socket_id);
+    if (it == sockets_.end()) {
+        throw ZmqCommunicationError("Unknown socket id");
+    }
+    return *it->second.socket;
+}
+
+void ZmqReactor::post(int socket_id, const std::string& message) {
+    std::lock_guard<std::mutex> lock(post_mutex_);
+
+    zmq::message_t header(sizeof(socket_id));
+    memcpy(header.data(), &socket_id, sizeof(socket_id));
+    zmq::message_t body(message.size());
+    memcpy(body.data(), message.data(), message.size());
+
+    try {
+        outbox_->send(header, zmq::send_flags::sndmore);
+        outbox_->send(body, zmq::send_flags::none);
+    } catch (const zmq::error_t& e) {
+        throw ZmqCommunicationError(e.what());
+    }
+}
+
+void ZmqReactor::stop() {
+    running_ = false;
+    post(kStopId, "");
+}
+
+void ZmqReactor::run() {
+    running_ = true;
+
+    std::vector<zmq::pollitem_t> items;
+    std::vector<int> ids;
+
+    while (running_) {
+        // 处理函数可能增删 socket, 每轮重建 poll 列表
+        items.clear();
+        ids.clear();
+        items.push_back({static_cast<void*>(*inbox_), 0, ZMQ_POLLIN, 0});
+        for (auto& entry : sockets_) {
+            if (!entry.second.on_readable) continue;
+            items.push_back({static_cast<void*>(*entry.second.socket), 0, ZMQ_POLLIN, 0});
+            ids.push_back(entry.first);
+        }
+
+        try {
+            zmq::poll(items.data(), items.size(), std::chrono::milliseconds(nextTimeoutMs()));
+        } catch (const zmq::error_t& e) {
+            if (e.num() == EINTR) continue;
+            throw ZmqCommunicationError(e.what());
+        }
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            drainPosted();
+        }
+        for (size_t i = 1; i < items.size() && running_; ++i) {
+            if (!(items[i].revents & ZMQ_POLLIN)) continue;
+            auto it = sockets_.find(ids[i - 1]);
+            if (it != sockets_.end()) {
+                it->second.on_readable(*it->second.socket);
+            }
+        }
+        fireTimers();
+    }
+}
+
+void ZmqReactor::drainPosted() {
+    while (running_) {
+        zmq::message_t header;
+        if (!inbox_->recv(header, zmq::recv_flags::dontwait)) return;
+        zmq::message_t body;
+        (void)inbox_->recv(body, zmq::recv_flags::none);
+
+        int socket_id = kStopId;
+        if (header.size() == sizeof(socket_id)) {
+            memcpy(&socket_id, header.data(), sizeof(socket_id));
+        }
+        if (socket_id == kStopId) {
+            running_ = false;
+            return;
+        }
+
+        auto it = sockets_.find(socket_id);
+        if (it == sockets_.end()) continue;
+
+        std::string message(static_cast<char*>(body.data()), body.size());
+        if (it->second.on_post) {
+            it->second.on_post(*it->second.socket, message);
+        } else {
+            send(*it->second.socket, message);
+        }
+    }
+}
+
+void ZmqReactor::fireTimers() {
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<int> due;
+    for (const auto& entry : timers_) {
+        if (entry.second.deadline <= now) due.push_back(entry.first);
+    }
+
+    for (int id : due) {
+        auto it = timers_.find(id);
+        if (it == timers_.end()) continue;  // 被之前的回调取消
+
+        TimerHandler handler = it->second.handler;
+        if (it->second.repeat) {
+            it->second.deadline = now + it->second.interval;
+        } else {
+            timers_.erase(it);
+        }
+        handler();
+    }
+}
+
+long ZmqReactor::nextTimeoutMs() const {
+    if (timers_.empty()) return -1;
+
+    auto now      = std::chrono::steady_clock::now();
+    auto earliest = timers_.begin()->second.deadline;
+    for (const auto& entry : timers_) {
+        earliest = std::min(earliest, entry.second.deadline);
+    }
+    if (earliest <= now) return 0;
+
+    // 向上取整, 避免定时器到期前被提前唤醒后空转
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(earliest - now);
+    return static_cast<long>(wait.count()) + 1;
+}
+
+std::string ZmqReactor::receive(zmq::socket_t& socket) {
+    zmq::message_t request;
+
+    auto result = socket.recv(request, zmq::recv_flags::none);
+    if (!result) {
+        throw ZmqCommunicationError("Receive timeout");
+    }
+
+    return {static_cast<char*>(request.data()), request.size()};
+}
+
+std::vector<std::string> ZmqReactor::receiveMultipart(zmq::socket_t& socket) {
+    std::vector<std::string> frames;
+
+    do {
+        zmq::message_t request;
+        auto result = socket.recv(request, zmq::recv_flags::none);
+        if (!result) {
+            throw ZmqCommunicationError("Receive timeout");
+        }
+        frames.emplace_back(static_cast<char*>(request.data()), request.size());
+    } while (socket.get(zmq::sockopt::rcvmore));
+
+    return frames;
+}
+
+void ZmqReactor::send(zmq::socket_t& socket, const std::string& message) {
+    zmq::message_t reply(message.size());
+    memcpy(reply.data(), message.c_str(), message.size());
+
+    auto result = socket.send(reply, zmq::send_flags::none);
+    if (!result) {
+        throw ZmqCommunicationError("Send timeout");
+    }
+}
+
+}  // namespace zmq_component
@@ -15,6 +15,21 @@ std::string ZmqServer::receive() {
     return {static_cast<char *>(request.data()), request.size()};
 }
 
+std::vector<std::string> ZmqServer::receiveMultipart() {
+    std::vector<std::string> frames;
+
+    do {
+        zmq::message_t request;
+        auto result = socket_->recv(request, zmq::recv_flags::none);
+        if (!result) {
+            throw ZmqCommunicationError("Receive timeout");
+        }
+        frames.emplace_back(static_cast<char *>(request.data()), request.size());
+    } while (socket_->get(zmq::sockopt::rcvmore));
+
+    return frames;
+}
+
 void ZmqServer::send(const std::string &response) {
     zmq::message_t reply(response.size());
     memcpy(reply.data(), response.c_str(), response.size());